@@ -3,78 +3,56 @@
 in vec3 FragPos;
 in vec3 Normal;
 in vec3 ToCameraVector;
+#ifdef RECEIVE_SHADOW
 in vec4 LightSpaceFragPos;
+#endif
 in vec4 ViewSpace;
 smooth in vec4 CurPos;
+in vec4 VertexColor;
 
 layout(location = 0) out vec4 colorTexture;
 
 uniform vec3 color;
 uniform vec3 lightPos;
-uniform sampler2D shadowMap;
 uniform float opacity;
 uniform float ambientLightIntensity;
-uniform int receiveShadow;
 
-float shadowCalculation(vec4 lightSpaceFragPos) {
-  vec3 projCoords = lightSpaceFragPos.xyz / lightSpaceFragPos.w;
-  projCoords = projCoords * 0.5 + 0.5;
-  float closestDepth = texture(shadowMap, projCoords.xy).r;
-  float currentDepth = projCoords.z;
-  if (currentDepth > 1.0)
-    return 0;
-  float shadow = 0.0;
-  float bias = max(0.002 * (1.0 - dot(Normal, normalize(lightPos))), 0.0005);
-  vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
-  int sampleSize = 1;
-  for (int x = -sampleSize; x <= sampleSize; ++x) {
-    for (int y = -sampleSize; y <= sampleSize; ++y) {
-      float pcfDepth =
-          texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
-      shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
-    }
-  }
-  return shadow / ((sampleSize * 2 + 1) * (sampleSize * 2 + 1));
-}
+// FOG_NEAR and FOG_FAR are injected by the program
+#ifndef FOG_NEAR
+#define FOG_NEAR 100.0
+#endif
+#ifndef FOG_FAR
+#define FOG_FAR 500.0
+#endif
+
+#include "lighting.glsl"
+
+// only the RECEIVE_SHADOW variant samples the shadow maps
+#ifdef RECEIVE_SHADOW
+#include "shadowSampling.glsl"
+#endif
 
 void main() {
   vec3 fogColor = vec3(0.968, 0.851, 0.667);
   vec3 unitNormal = normalize(Normal);
   vec3 unitToCameraVector = normalize(ToCameraVector);
 
-  // directional light
-  vec3 lightColor = vec3(1.0, 1.0, 1.0);
-  vec3 lightDir = normalize(lightPos - FragPos);
-
-  // ambient
-  float ambientStrength = 0.4 * ambientLightIntensity;
-  vec3 ambient = ambientStrength * lightColor;
-
-  // diffuse
-  float diff = max(dot(unitNormal, lightDir), 0.0);
-  vec3 diffuse = diff * lightColor;
-
-  // specular
-  float specularStrength = 0.5;
-  vec3 reflectedLightDir = reflect(-lightDir, unitNormal);
-  float specularFactor =
-      pow(max(dot(reflectedLightDir, unitToCameraVector), 0.0), 64);
-  vec3 specular = specularStrength * specularFactor * lightColor;
+  Lighting lighting = pointLight(FragPos, unitNormal, unitToCameraVector, lightPos, ambientLightIntensity);
 
   // shadow
-  float visibility = 1.0;
+#ifdef RECEIVE_SHADOW
+  float bias = max(0.3 * (1.0 - dot(Normal, normalize(lightPos))), 0.05);
+  float shadow = shadowCalculation(LightSpaceFragPos, bias);
+#else
   float shadow = 0.0;
-  if (receiveShadow == 1)
-    shadow = visibility * shadowCalculation(LightSpaceFragPos);
-  vec3 fragColor = (ambient + (1 - shadow) * (diffuse + specular)) * color;
+#endif
+  vec3 fragColor = (lighting.ambient + (1 - shadow) * (lighting.diffuse + lighting.specular)) * color * VertexColor.rgb;
 
   // fog
   float dist = abs(ViewSpace.z);
-  float near = 100.0;
-  float far = 500.0;
-  float fogFactor = (far - dist) / (far - near);
+  float fogFactor = (FOG_FAR - dist) / (FOG_FAR - FOG_NEAR);
   fogFactor = clamp(fogFactor, 0.0, 1.0);
 
   vec3 finalColor = (1.0 - fogFactor) * fogColor + fogFactor * fragColor;
-  colorTexture = vec4(finalColor, opacity);
+  colorTexture = vec4(finalColor, opacity * VertexColor.a);
 }
@@ -2,13 +2,18 @@
 #version 330 core
 in vec3 position;
 in vec3 normal;
+// baked models carry per-vertex colors, other models read the default (1, 1, 1, 1)
+in vec4 vertexColor;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec3 ToCameraVector;
+#ifdef RECEIVE_SHADOW
 out vec4 LightSpaceFragPos;
+#endif
 out vec4 ViewSpace;
 smooth out vec4 CurPos;
+out vec4 VertexColor;
 
 uniform mat4 transformationMatrix;
 uniform mat4 projectionMatrix;
@@ -26,5 +31,8 @@ void main() {
   Normal = normalize(mat3(transpose(inverse(transformationMatrix))) * normal);
   ToCameraVector =
       (inverse(viewMatrix) * vec4(0.0, 0.0, 0.0, 1.0)).xyz - worldPosition.xyz;
+#ifdef RECEIVE_SHADOW
   LightSpaceFragPos = lightSpaceMatrix * worldPosition;
+#endif
+  VertexColor = vertexColor;
 }
@@ -1,7 +0,0 @@
-// entityShadow.frag
-#version 330 core
-
-layout (location = 0) out float fragmentDepth;
-
-void main() {
-}
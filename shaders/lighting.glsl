@@ -0,0 +1,30 @@
+// lighting.glsl
+// the white point light at lightPos, split into its terms so receivers can
+// shadow the direct part only
+struct Lighting {
+  vec3 ambient;
+  vec3 diffuse;
+  vec3 specular;
+};
+
+Lighting pointLight(vec3 fragPos, vec3 unitNormal, vec3 unitToCameraVector, vec3 lightPos, float ambientLightIntensity) {
+  vec3 lightColor = vec3(1.0, 1.0, 1.0);
+  vec3 lightDir = normalize(lightPos - fragPos);
+  Lighting lighting;
+
+  // ambient
+  float ambientStrength = 0.4 * ambientLightIntensity;
+  lighting.ambient = ambientStrength * lightColor;
+
+  // diffuse
+  float diff = max(dot(unitNormal, lightDir), 0.0);
+  lighting.diffuse = diff * lightColor;
+
+  // specular
+  float specularStrength = 0.5;
+  vec3 reflectedLightDir = reflect(-lightDir, unitNormal);
+  float specularFactor =
+      pow(max(dot(reflectedLightDir, unitToCameraVector), 0.0), 64);
+  lighting.specular = specularStrength * specularFactor * lightColor;
+  return lighting;
+}
@@ -0,0 +1,41 @@
+// particle.frag
+#version 330 core
+in vec3 FragPos;
+in vec3 Normal;
+in vec3 ToCameraVector;
+in vec4 ViewSpace;
+flat in vec3 Color;
+
+layout(location = 0) out vec4 colorTexture;
+
+uniform vec3 lightPos;
+uniform float ambientLightIntensity;
+
+// FOG_NEAR and FOG_FAR are injected by the program
+#ifndef FOG_NEAR
+#define FOG_NEAR 100.0
+#endif
+#ifndef FOG_FAR
+#define FOG_FAR 500.0
+#endif
+
+#include "lighting.glsl"
+
+void main() {
+  vec3 fogColor = vec3(0.968, 0.851, 0.667);
+  vec3 unitNormal = normalize(Normal);
+  vec3 unitToCameraVector = normalize(ToCameraVector);
+
+  Lighting lighting = pointLight(FragPos, unitNormal, unitToCameraVector, lightPos, ambientLightIntensity);
+
+  // particles never receive shadow
+  vec3 fragColor = (lighting.ambient + lighting.diffuse + lighting.specular) * Color;
+
+  // fog
+  float dist = abs(ViewSpace.z);
+  float fogFactor = (FOG_FAR - dist) / (FOG_FAR - FOG_NEAR);
+  fogFactor = clamp(fogFactor, 0.0, 1.0);
+
+  vec3 finalColor = (1.0 - fogFactor) * fogColor + fogFactor * fragColor;
+  colorTexture = vec4(finalColor, 1.0);
+}
@@ -0,0 +1,42 @@
+// particle.vert
+#version 330 core
+in vec3 position;
+in vec3 normal;
+in vec3 origin;
+in vec3 velocity;
+in vec3 color;
+in float scale;
+in float spawnTime;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec3 ToCameraVector;
+out vec4 ViewSpace;
+flat out vec3 Color;
+
+uniform mat4 projectionMatrix;
+uniform mat4 viewMatrix;
+uniform float time;
+uniform float lifespan;
+
+#include "particleMotion.glsl"
+
+void main() {
+  float age = time - spawnTime;
+  if (age < 1.0 || age >= lifespan) {
+    gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+    return;
+  }
+
+  mat3 rotationMatrix = rotation(age);
+  float size = scale * (lifespan - age + 1.0) / lifespan;
+  vec4 worldPosition = vec4(center(age) + rotationMatrix * (position * size), 1.0);
+  ViewSpace = viewMatrix * worldPosition;
+  gl_Position = projectionMatrix * ViewSpace;
+
+  FragPos = vec3(worldPosition);
+  Normal = normalize(rotationMatrix * normal);
+  ToCameraVector =
+      (inverse(viewMatrix) * vec4(0.0, 0.0, 0.0, 1.0)).xyz - worldPosition.xyz;
+  Color = color;
+}
@@ -0,0 +1,32 @@
+// particleMotion.glsl
+// where a particle is and how it is turned at a given age, shared by the
+// color and shadow passes. Needs the origin, velocity and spawnTime attributes
+const float DECELERATION = 0.04;
+const float GRAVITY = 0.06;
+const float MAX_SPIN = 12.0;
+
+float random(float seed) {
+  return fract(sin(seed) * 43758.5453);
+}
+
+mat3 rotation(float age) {
+  // particles of one burst share origin and spawn time, velocity tells them apart
+  float seed = dot(origin, vec3(12.9898, 78.233, 37.719)) + spawnTime + dot(velocity, vec3(91.7, 13.3, 0.0));
+  float angleX = age * MAX_SPIN * random(seed);
+  float angleY = age * MAX_SPIN * random(seed + 1.0);
+  mat3 rotationX = mat3(1.0, 0.0, 0.0,
+                        0.0, cos(angleX), sin(angleX),
+                        0.0, -sin(angleX), cos(angleX));
+  mat3 rotationY = mat3(cos(angleY), 0.0, -sin(angleY),
+                        0.0, 1.0, 0.0,
+                        sin(angleY), 0.0, cos(angleY));
+  return rotationX * rotationY;
+}
+
+vec3 center(float age) {
+  // x slows down until it stops, y keeps falling
+  float moveAge = min(age, floor(abs(velocity.x) / DECELERATION));
+  float dx = sign(velocity.x) * (abs(velocity.x) * moveAge - DECELERATION * moveAge * (moveAge + 1.0) * 0.5);
+  float dy = velocity.y * age - GRAVITY * age * (age + 1.0) * 0.5;
+  return origin + vec3(dx, dy, 0.0);
+}
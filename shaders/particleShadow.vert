@@ -0,0 +1,25 @@
+// particleShadow.vert
+#version 330 core
+in vec3 position;
+in vec3 origin;
+in vec3 velocity;
+in float scale;
+in float spawnTime;
+
+uniform mat4 lightSpaceMatrix;
+uniform float time;
+uniform float lifespan;
+
+#include "particleMotion.glsl"
+
+void main() {
+  float age = time - spawnTime;
+  if (age < 1.0 || age >= lifespan) {
+    gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+    return;
+  }
+
+  float size = scale * (lifespan - age + 1.0) / lifespan;
+  vec3 worldPosition = center(age) + rotation(age) * (position * size);
+  gl_Position = lightSpaceMatrix * vec4(worldPosition, 1.0);
+}
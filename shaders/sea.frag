@@ -9,28 +9,17 @@ layout (location = 0) out vec4 colorTexture;
 // layout (location = 1) out vec4 velocityTexture;
 
 uniform vec3 lightPos;
-uniform sampler2D shadowMap;
 uniform float ambientLightIntensity;
 
-float shadowCalculation(vec4 lightSpaceFragPos) {
-  vec3 projCoords = lightSpaceFragPos.xyz / lightSpaceFragPos.w;
-  projCoords = projCoords * 0.5 + 0.5;
-  float closestDepth = texture(shadowMap, projCoords.xy).r;
-  float currentDepth = projCoords.z;
-  if (currentDepth > 1.0)
-    return 0;
-  float shadow = 0.0;
-  float bias = max(0.05 * (1.0 - dot(Normal, normalize(-lightPos))), 0.001);
-  vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
-  int sampleSize = 1;
-  for(int x = -sampleSize; x <= sampleSize; ++x) {
-    for(int y = -sampleSize; y <= sampleSize; ++y) {
-        float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
-        shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
-    }
-  }
-  return shadow / ((sampleSize * 2 + 1) * (sampleSize * 2 + 1));
-}
+// FOG_NEAR and FOG_FAR are injected by the program
+#ifndef FOG_NEAR
+#define FOG_NEAR 100.0
+#endif
+#ifndef FOG_FAR
+#define FOG_FAR 300.0
+#endif
+
+#include "shadowSampling.glsl"
 
 void main() {
   vec3 seaColor = vec3(0.408, 0.765, 0.753);
@@ -50,14 +39,15 @@ void main() {
 
   // shadow
   float visibility = 1.0;
-  float shadow = visibility * shadowCalculation(LightSpaceFragPos);
+  // the shadow pass draws a coarser sea LOD, whose waves can sit a little
+  // above the surface drawn here
+  float bias = max(4.0 * (1.0 - dot(Normal, normalize(-lightPos))), 2.0);
+  float shadow = visibility * shadowCalculation(LightSpaceFragPos, bias);
   vec3 fragColor = (ambient + (1 - shadow) * diffuse) * seaColor;
 
   // fog
   float dist = abs(ViewSpace.z);
-  float near = 100.0;
-  float far = 300.0;
-  float fogFactor = (far - dist)/(far - near);
+  float fogFactor = (FOG_FAR - dist) / (FOG_FAR - FOG_NEAR);
   fogFactor = clamp(fogFactor, 0.0, 1.0);
 
   vec3 finalColor = (1.0 - fogFactor) * fogColor + fogFactor * fragColor;
@@ -5,13 +5,16 @@ in vec3 wave;
 
 uniform mat4 transformationMatrix;
 uniform float time;
+// positions are stored normalized by the largest coordinate
+uniform float positionScale;
 
 void main() {
+  vec3 vertex = position * positionScale;
   // update wave position
   float angle = wave.x;
   float amplitude = wave.y;
   float speed = wave.z;
-  float newX = position.x + cos(angle + time * speed) * amplitude;
-  float newY = position.y + sin(angle + time * speed) * amplitude;
-  gl_Position = transformationMatrix * vec4(newX, newY, position.z, 1.0);
+  float newX = vertex.x + cos(angle + time * speed) * amplitude;
+  float newY = vertex.y + sin(angle + time * speed) * amplitude;
+  gl_Position = transformationMatrix * vec4(newX, newY, vertex.z, 1.0);
 }
@@ -1,4 +1,4 @@
-// seaShadow.frag
+// shadow.frag
 #version 330 core
 
 layout (location = 0) out float fragmentDepth;
@@ -0,0 +1,29 @@
+// shadow.vert
+#version 330 core
+in vec3 position;
+// the SEA_WAVES variant displaces the sea the same way sea.vert does
+#ifdef SEA_WAVES
+in vec3 wave;
+#endif
+
+uniform mat4 transformationMatrix;
+uniform mat4 lightSpaceMatrix;
+#ifdef SEA_WAVES
+uniform float time;
+// positions are stored normalized by the largest coordinate
+uniform float positionScale;
+#endif
+
+void main() {
+#ifdef SEA_WAVES
+  vec3 vertex = position * positionScale;
+  float angle = wave.x;
+  float amplitude = wave.y;
+  float speed = wave.z;
+  float newX = vertex.x + cos(angle + time * speed) * amplitude;
+  float newY = vertex.y + sin(angle + time * speed) * amplitude;
+  gl_Position = lightSpaceMatrix * transformationMatrix * vec4(newX, newY, vertex.z, 1.0);
+#else
+  gl_Position = lightSpaceMatrix * transformationMatrix * vec4(position, 1.0);
+#endif
+}
@@ -0,0 +1,65 @@
+// shadowSampling.glsl
+// filtered lookups into both shadow layers, shared by every shadow receiver
+uniform sampler2DShadow shadowMap;
+uniform sampler2DShadow dynamicShadowMap;
+
+// SHADOW_KERNEL_TAPS is injected by the program: 1, 4 or 9 bilinear taps,
+// or 16 for a Poisson disk
+#ifndef SHADOW_KERNEL_TAPS
+#define SHADOW_KERNEL_TAPS 4
+#endif
+
+// SHADOW_DEPTH_RANGE is injected as well: the world units the shadow map's
+// depth spans, so receivers can bias by world distances
+#ifndef SHADOW_DEPTH_RANGE
+#define SHADOW_DEPTH_RANGE 220.0
+#endif
+
+#if SHADOW_KERNEL_TAPS == 16
+const vec2 POISSON_DISK[16] = vec2[](
+  vec2(-0.942, -0.399), vec2(0.946, -0.769), vec2(-0.094, -0.929), vec2(0.345, 0.294),
+  vec2(-0.916, 0.458), vec2(-0.815, -0.879), vec2(-0.383, 0.277), vec2(0.975, 0.756),
+  vec2(0.443, -0.975), vec2(0.537, -0.474), vec2(-0.265, -0.419), vec2(0.792, 0.191),
+  vec2(-0.242, 0.997), vec2(-0.814, 0.914), vec2(0.200, 0.786), vec2(0.144, -0.141)
+);
+#endif
+
+// lit fraction of one hardware-filtered depth compare, merged over both layers
+float lit(vec2 uv, float depth) {
+  vec3 coord = vec3(uv, depth);
+  return min(texture(shadowMap, coord), texture(dynamicShadowMap, coord));
+}
+
+// bias is a world distance
+float shadowCalculation(vec4 lightSpaceFragPos, float bias) {
+  vec3 projCoords = lightSpaceFragPos.xyz / lightSpaceFragPos.w;
+  projCoords = projCoords * 0.5 + 0.5;
+  if (projCoords.z > 1.0)
+    return 0.0;
+  float depth = projCoords.z - bias / SHADOW_DEPTH_RANGE;
+  vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
+  float visibility = 0.0;
+#if SHADOW_KERNEL_TAPS == 1
+  visibility = lit(projCoords.xy, depth);
+#elif SHADOW_KERNEL_TAPS == 4
+  // each bilinear tap covers 2x2 texels, four of them cover 3x3
+  for (int i = 0; i < 4; ++i) {
+    vec2 offset = vec2(i & 1, i >> 1) - 0.5;
+    visibility += lit(projCoords.xy + offset * texelSize, depth);
+  }
+  visibility *= 0.25;
+#elif SHADOW_KERNEL_TAPS == 9
+  for (int x = -1; x <= 1; ++x) {
+    for (int y = -1; y <= 1; ++y) {
+      visibility += lit(projCoords.xy + vec2(x, y) * texelSize, depth);
+    }
+  }
+  visibility /= 9.0;
+#else
+  for (int i = 0; i < 16; ++i) {
+    visibility += lit(projCoords.xy + POISSON_DISK[i] * 1.5 * texelSize, depth);
+  }
+  visibility /= 16.0;
+#endif
+  return 1.0 - visibility;
+}
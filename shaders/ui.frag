@@ -1,31 +1,16 @@
 // ui.frag
 #version 330 core
+in vec2 UV;
+in vec4 Color;
+
 out vec4 out_Color;
 
-uniform float health;
-uniform float width;
-uniform float height;
+// signed distance field, 0.5 on the glyph outline; rectangles sample a solid cell
+uniform sampler2D atlas;
 
 void main() {
-  float x = gl_FragCoord.x;
-  float y = gl_FragCoord.y;
-  float size = height / 40;
-  float padding = size / 5;
-  float interval = size + padding;
-  float yOffset = height - 2 * size;
-  float xOffset = 2 * size;
-  float length = (health / 5) * interval;
-  if (y >= yOffset || y < yOffset - size || x < xOffset || x > xOffset + length) {
-    discard;
-  }
-  x -= xOffset;
-  x -= floor(x / interval) * interval;
-  if (x > size) {
-    discard;
-  }
-  if (health < 30.0) {
-    out_Color = vec4(242.0f/255.0f, 53.0f/255.0f, 30.0f/255.0f, 0.8f);
-  } else {
-    out_Color = vec4(104.0f/255.0f, 195.0f/255.0f, 192.0f/255.0f, 0.8f);
-  }
-}
\ No newline at end of file
+  float distance = texture(atlas, UV).r;
+  float smoothing = max(fwidth(distance), 0.001);
+  float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);
+  out_Color = vec4(Color.rgb, Color.a * alpha);
+}
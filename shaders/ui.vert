@@ -1,7 +1,18 @@
 // ui.vert
 #version 330 core
 in vec2 position;
+in vec2 uv;
+in vec4 color;
+
+out vec2 UV;
+out vec4 Color;
+
+uniform float width;
+uniform float height;
 
 void main() {
-  gl_Position = vec4(position, 0.0f, 1.0f);
-}
\ No newline at end of file
+  // pixels with the origin at the bottom left
+  gl_Position = vec4(position / vec2(width, height) * 2.0 - 1.0, 0.0, 1.0);
+  UV = uv;
+  Color = color;
+}
@@ -0,0 +1,141 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+#include "Utilities.h"
+
+FrameArena g_frameArena;
+
+static void* AlignedAlloc( size_t size )
+{
+#ifdef _WIN32
+    return _aligned_malloc( size, alignof( std::max_align_t ) );
+#else
+    return std::aligned_alloc( alignof( std::max_align_t ), AlignUp( size, alignof( std::max_align_t ) ) );
+#endif
+}
+
+static void AlignedFree( void* ptr )
+{
+#ifdef _WIN32
+    _aligned_free( ptr );
+#else
+    std::free( ptr );
+#endif
+}
+
+FrameArena::FrameArena( size_t capacity )
+    : mBlock( static_cast<uint8_t*>( AlignedAlloc( capacity ) ) )
+    , mCapacity( capacity )
+    , mOffset( 0 )
+    , mOverflowBytes( 0 )
+    , mSpilled( false )
+{
+    if ( !mBlock )
+    {
+        throw std::bad_alloc();
+    }
+}
+
+FrameArena::~FrameArena()
+{
+    for ( void* ptr : mOverflow )
+    {
+        AlignedFree( ptr );
+    }
+    AlignedFree( mBlock );
+}
+
+void* FrameArena::Allocate( size_t size, size_t alignment )
+{
+    assert( alignment && ( alignment & ( alignment - 1 ) ) == 0 );
+    assert( alignment <= alignof( std::max_align_t ) );
+
+    ++mStats.allocations;
+
+    const size_t offset = AlignUp( mOffset, alignment );
+    if ( offset + size <= mCapacity )
+    {
+        mStats.bytesUsed += offset + size - mOffset;
+        mOffset = offset + size;
+        mStats.peakBytes = std::max( mStats.peakBytes, mStats.bytesUsed );
+        return mBlock + offset;
+    }
+
+    void* ptr = AlignedAlloc( std::max<size_t>( size, 1 ) );
+    if ( !ptr )
+    {
+        throw std::bad_alloc();
+    }
+
+    mOverflow.push_back( ptr );
+    mOverflowBytes += size;
+    mSpilled = true;
+    ++mStats.overflowAllocations;
+    mStats.bytesUsed += size;
+    mStats.peakBytes = std::max( mStats.peakBytes, mStats.bytesUsed );
+    return ptr;
+}
+
+void FrameArena::FreeOverflow( size_t keep )
+{
+    for ( size_t i = keep; i < mOverflow.size(); ++i )
+    {
+        AlignedFree( mOverflow[i] );
+    }
+    mOverflow.resize( keep );
+}
+
+void FrameArena::Rewind( const Marker& marker )
+{
+    assert( marker.offset <= mOffset );
+    assert( marker.overflowCount <= mOverflow.size() );
+    mStats.bytesUsed -= ( mOffset - marker.offset ) + ( mOverflowBytes - marker.overflowBytes );
+    mOffset = marker.offset;
+    FreeOverflow( marker.overflowCount );
+    mOverflowBytes = marker.overflowBytes;
+
+    // nothing is live any more: the block can be replaced and the counters
+    // start over, as after Reset()
+    if ( mOffset == 0 && mOverflow.empty() )
+    {
+        if ( mSpilled )
+        {
+            Grow();
+        }
+        mStats.allocations = 0;
+        mStats.overflowAllocations = 0;
+    }
+}
+
+void FrameArena::Reset()
+{
+    FreeOverflow( 0 );
+    if ( mSpilled )
+    {
+        Grow();
+    }
+
+    mOffset = 0;
+    mOverflowBytes = 0;
+    mStats.allocations = 0;
+    mStats.bytesUsed = 0;
+    mStats.overflowAllocations = 0;
+}
+
+// grow to the peak so work that spilled fits in the block next time
+void FrameArena::Grow()
+{
+    const size_t capacity = AlignUp( mStats.peakBytes + mStats.peakBytes / 4, 4096 );
+    AlignedFree( mBlock );
+    mBlock = static_cast<uint8_t*>( AlignedAlloc( capacity ) );
+    if ( !mBlock )
+    {
+        throw std::bad_alloc();
+    }
+    mCapacity = capacity;
+    mSpilled = false;
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Linear allocator for data that lives at most one frame. Allocation bumps
+// an offset, Reset() releases everything at once. When the block runs out,
+// requests spill into heap blocks that are freed on Reset() or by rewinding
+// past them, and the block grows to the peak usage once the arena is empty
+// again, so the next frame fits.
+class FrameArena {
+   public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 20;
+
+    struct Stats {
+        size_t allocations = 0;          // this frame
+        size_t bytesUsed = 0;            // this frame, including spills
+        size_t peakBytes = 0;            // over the arena's lifetime
+        size_t overflowAllocations = 0;  // this frame
+    };
+
+    explicit FrameArena( size_t capacity = DEFAULT_CAPACITY );
+    ~FrameArena();
+
+    FrameArena( const FrameArena& ) = delete;
+    FrameArena& operator=( const FrameArena& ) = delete;
+
+    void* Allocate( size_t size, size_t alignment = alignof( std::max_align_t ) );
+
+    template<typename T>
+    T* AllocateArray( size_t count )
+    {
+        return static_cast<T*>( Allocate( count * sizeof( T ), alignof( T ) ) );
+    }
+
+    void Reset();
+
+    // Where the arena is, including the spills made so far.
+    struct Marker {
+        size_t offset;
+        size_t overflowCount;
+        size_t overflowBytes;
+    };
+
+    inline Marker GetMarker() const { return Marker{ mOffset, mOverflow.size(), mOverflowBytes }; }
+    // Frees everything allocated after the marker, spills included. Rewinding
+    // to an empty arena grows the block like Reset() does.
+    void Rewind( const Marker& marker );
+
+    inline size_t Capacity() const { return mCapacity; }
+    inline const Stats& GetStats() const { return mStats; }
+
+   private:
+    void FreeOverflow( size_t keep );
+    void Grow();
+
+    uint8_t* mBlock;
+    size_t mCapacity;
+    size_t mOffset;
+    std::vector<void*> mOverflow;
+    size_t mOverflowBytes;
+    // set by a spill, cleared when the block has grown
+    bool mSpilled;
+    Stats mStats;
+};
+
+// Restores the arena to where it was when the scope was entered.
+class ScratchScope {
+   public:
+    explicit ScratchScope( FrameArena& arena )
+        : mArena( arena )
+        , mMarker( arena.GetMarker() )
+    {
+    }
+
+    ~ScratchScope()
+    {
+        mArena.Rewind( mMarker );
+    }
+
+    ScratchScope( const ScratchScope& ) = delete;
+    ScratchScope& operator=( const ScratchScope& ) = delete;
+
+    inline FrameArena& Arena() { return mArena; }
+
+   private:
+    FrameArena& mArena;
+    FrameArena::Marker mMarker;
+};
+
+// STL allocator backed by a FrameArena. deallocate() is a no-op, memory is
+// reclaimed when the arena is reset or rewound, so containers using it must
+// not outlive that point.
+template<typename T>
+class ArenaAllocator {
+   public:
+    using value_type = T;
+
+    ArenaAllocator( FrameArena& arena )
+        : mArena( &arena )
+    {
+    }
+
+    template<typename U>
+    ArenaAllocator( const ArenaAllocator<U>& other )
+        : mArena( other.GetArena() )
+    {
+    }
+
+    T* allocate( size_t count )
+    {
+        return mArena->AllocateArray<T>( count );
+    }
+
+    void deallocate( T*, size_t )
+    {
+    }
+
+    inline FrameArena* GetArena() const { return mArena; }
+
+    template<typename U>
+    bool operator==( const ArenaAllocator<U>& rhs ) const { return mArena == rhs.GetArena(); }
+    template<typename U>
+    bool operator!=( const ArenaAllocator<U>& rhs ) const { return mArena != rhs.GetArena(); }
+
+   private:
+    FrameArena* mArena;
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Arena reset once per frame by the main loop.
+extern FrameArena g_frameArena;
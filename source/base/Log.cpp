@@ -1,36 +1,205 @@
-#include "log.h"
+#include "Log.h"
 
 #define _CRT_SECURE_NO_WARNINGS
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#else
+#include <csignal>
+#include <unistd.h>
+#endif
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdarg>
 #include <cstdio>
 #include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #define ENDPOINT stdout
 
 namespace internal {
-void Log( LogLevel level, const char* fmt, ... )
-{
-    char buffer1[1024];
-    va_list args;
-    va_start( args, fmt );
-    vsnprintf( buffer1, sizeof( buffer1 ), fmt, args );
-    va_end( args );
 
-    time_t rawtime;
-    struct tm* timeinfo;
-    std::time( &rawtime );
-    timeinfo = localtime( &rawtime );
-    char timebuf[128];
-    strftime( timebuf, sizeof( timebuf ), "%H:%M:%S", timeinfo );
+struct LogRecord {
+    // same limit the synchronous logger had
+    static constexpr size_t MAX_TEXT = 1024;
+
+    LogLevel level;
+    int64_t timestamp;  // milliseconds since epoch
+    char text[MAX_TEXT];
+};
+
+// Single producer (the owning thread), single consumer (the writer thread).
+class LogRing {
+   public:
+    static constexpr uint32_t CAPACITY = 256;  // power of two
+
+    // Returns false without touching args when the ring is full, otherwise
+    // the number of records waiting, this one included, through fill.
+    bool Push( LogLevel level, const char* fmt, va_list args, uint32_t& fill )
+    {
+        const uint32_t head = mHead.load( std::memory_order_relaxed );
+        fill = head - mTail.load( std::memory_order_acquire ) + 1;
+        if ( fill > CAPACITY )
+        {
+            return false;
+        }
+
+        LogRecord& record = mRecords[head & ( CAPACITY - 1 )];
+        record.level = level;
+        record.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               std::chrono::system_clock::now().time_since_epoch() )
+                               .count();
+        vsnprintf( record.text, sizeof( record.text ), fmt, args );
+
+        mHead.store( head + 1, std::memory_order_release );
+        return true;
+    }
+
+    template<typename FUNC>
+    uint32_t Drain( FUNC&& func )
+    {
+        const uint32_t tail = mTail.load( std::memory_order_relaxed );
+        const uint32_t head = mHead.load( std::memory_order_acquire );
+        for ( uint32_t i = tail; i != head; ++i )
+        {
+            func( mRecords[i & ( CAPACITY - 1 )] );
+        }
+        mTail.store( head, std::memory_order_release );
+        return head - tail;
+    }
+
+    void CountDropped()
+    {
+        mDropped.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    uint32_t TakeDropped()
+    {
+        return mDropped.exchange( 0, std::memory_order_relaxed );
+    }
+
+   private:
+    alignas( 64 ) std::atomic<uint32_t> mHead{ 0 };
+    alignas( 64 ) std::atomic<uint32_t> mTail{ 0 };
+    std::atomic<uint32_t> mDropped{ 0 };
+    LogRecord mRecords[CAPACITY];
+};
 
-    char buffer2[2048];
-    snprintf( buffer2, sizeof( buffer2 ), "[%s] %s\n", timebuf, buffer1 );
+class Logger {
+   public:
+    Logger()
+    {
+        mThread = std::thread( [this]() { WriterLoop(); } );
+    }
 
+    ~Logger()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mLock );
+            mQuit = true;
+        }
+        mWake.notify_one();
+        mThread.join();
+    }
+
+    LogRing& ThreadRing()
+    {
+        // rings are owned by the logger so records outlive the thread that
+        // wrote them; the lease hands the ring back when the thread exits
+        thread_local RingLease s_lease;
+        if ( !s_lease.ring )
+        {
+            s_lease.ring = AcquireRing();
+            s_lease.logger = this;
+        }
+        return *s_lease.ring;
+    }
+
+    void Flush()
+    {
+        std::unique_lock<std::mutex> lock( mLock );
+        const uint64_t target = ++mFlushRequest;
+        mWake.notify_one();
+        mFlushed.wait( lock, [&]() { return mFlushDone >= target; } );
+    }
+
+    // starts a drain now instead of at the next tick
+    void Wake()
+    {
+        {
+            std::lock_guard<std::mutex> lock( mLock );
+            mPending = true;
+        }
+        mWake.notify_one();
+    }
+
+   private:
+    struct RingLease {
+        LogRing* ring = nullptr;
+        Logger* logger = nullptr;
+
+        ~RingLease()
+        {
+            if ( ring )
+            {
+                logger->ReleaseRing( ring );
+            }
+        }
+    };
+
+    LogRing* AcquireRing()
+    {
+        std::lock_guard<std::mutex> lock( mLock );
+        if ( !mFreeRings.empty() )
+        {
+            // records of the previous owner may still be waiting, they are
+            // drained in order before the new owner's
+            LogRing* ring = mFreeRings.back();
+            mFreeRings.pop_back();
+            return ring;
+        }
+        mRings.push_back( std::make_unique<LogRing>() );
+        return mRings.back().get();
+    }
+
+    void ReleaseRing( LogRing* ring )
+    {
+        std::lock_guard<std::mutex> lock( mLock );
+        mFreeRings.push_back( ring );
+    }
+
+    void WriterLoop();
+    uint32_t DrainAll();
+
+    std::thread mThread;
+    std::mutex mLock;
+    std::condition_variable mWake;
+    std::condition_variable mFlushed;
+    std::vector<std::unique_ptr<LogRing>> mRings;
+    // rings of threads that have exited, reused before new ones are made
+    std::vector<LogRing*> mFreeRings;
+    uint64_t mFlushRequest = 0;
+    uint64_t mFlushDone = 0;
+    bool mPending = false;
+    bool mQuit = false;
+};
+
+static Logger& TheLogger()
+{
+    static Logger s_logger;
+    return s_logger;
+}
+
+static void WriteToSinks( LogLevel level, const char* message )
+{
+#ifdef _WIN32
     // print to debugger
-    OutputDebugStringA( buffer2 );
+    OutputDebugStringA( message );
     // print to console
     constexpr WORD defaultStyle = ( FOREGROUND_RED | FOREGROUND_BLUE | FOREGROUND_GREEN );
 
@@ -57,12 +226,186 @@ void Log( LogLevel level, const char* fmt, ... )
 
     HANDLE hConsole = GetStdHandle( STD_OUTPUT_HANDLE );
     SetConsoleTextAttribute( hConsole, style );
-    fprintf( ENDPOINT, buffer2 );
+    fputs( message, ENDPOINT );
     SetConsoleTextAttribute( hConsole, defaultStyle );
+#else
+    const char* style = "";
+    switch ( level )
+    {
+        case LogLevel::Fatal:
+        case LogLevel::Error:
+            style = "\033[31m";
+            break;
+        case LogLevel::Warning:
+            style = "\033[33m";
+            break;
+        case LogLevel::Info:
+            style = "\033[34m";
+            break;
+        case LogLevel::Success:
+            style = "\033[32m";
+            break;
+        default:
+            break;
+    }
+    // colour codes would end up as garbage in redirected output
+    static const bool s_terminal = isatty( fileno( ENDPOINT ) ) != 0;
+    if ( s_terminal && *style )
+    {
+        fprintf( ENDPOINT, "%s%s\033[0m", style, message );
+    }
+    else
+    {
+        fputs( message, ENDPOINT );
+    }
+#endif
+}
+
+static void WriteRecord( const LogRecord& record )
+{
+    const time_t rawtime = static_cast<time_t>( record.timestamp / 1000 );
+    struct tm timeinfo;
+#ifdef _WIN32
+    localtime_s( &timeinfo, &rawtime );
+#else
+    localtime_r( &rawtime, &timeinfo );
+#endif
+    char timebuf[32];
+    strftime( timebuf, sizeof( timebuf ), "%H:%M:%S", &timeinfo );
+
+    char buffer[sizeof( record.text ) + 64];
+    snprintf( buffer, sizeof( buffer ), "[%s.%03d] %s\n", timebuf, static_cast<int>( record.timestamp % 1000 ), record.text );
+    WriteToSinks( record.level, buffer );
+}
+
+uint32_t Logger::DrainAll()
+{
+    std::vector<LogRing*> rings;
+    {
+        std::lock_guard<std::mutex> lock( mLock );
+        rings.reserve( mRings.size() );
+        for ( auto& ring : mRings )
+        {
+            rings.push_back( ring.get() );
+        }
+    }
+
+    uint32_t count = 0;
+    for ( LogRing* ring : rings )
+    {
+        count += ring->Drain( WriteRecord );
+        if ( const uint32_t dropped = ring->TakeDropped() )
+        {
+            char buffer[64];
+            snprintf( buffer, sizeof( buffer ), "[log] dropped %u message(s), ring full\n", dropped );
+            WriteToSinks( LogLevel::Warning, buffer );
+        }
+    }
+
+    if ( count )
+    {
+        fflush( ENDPOINT );
+    }
+
+    return count;
+}
+
+void Logger::WriterLoop()
+{
+    for ( ;; )
+    {
+        uint64_t flushRequest;
+        bool quit;
+        {
+            std::unique_lock<std::mutex> lock( mLock );
+            // the tick drains quiet rings; a flush, a filling ring or quit
+            // is picked up even when its notify came before the wait
+            mWake.wait_for( lock, std::chrono::milliseconds( 10 ),
+                            [this]() { return mQuit || mPending || mFlushRequest != mFlushDone; } );
+            mPending = false;
+            flushRequest = mFlushRequest;
+            quit = mQuit;
+        }
+
+        DrainAll();
+
+        {
+            std::lock_guard<std::mutex> lock( mLock );
+            mFlushDone = flushRequest;
+        }
+        mFlushed.notify_all();
+
+        if ( quit )
+        {
+            break;
+        }
+    }
+}
+
+// how long a full ring may hold up a record below Error
+static constexpr int MAX_WAIT_MS = 2;
+
+void Log( LogLevel level, const char* fmt, ... )
+{
+    Logger& logger = TheLogger();
+
+    LogRing& ring = logger.ThreadRing();
+    va_list args;
+    va_start( args, fmt );
+    uint32_t fill = 0;
+    if ( ring.Push( level, fmt, args, fill ) )
+    {
+        // once per fill-up, so a burst is drained before the ring runs over
+        if ( fill == LogRing::CAPACITY / 2 )
+        {
+            logger.Wake();
+        }
+    }
+    else
+    {
+        if ( level >= LogLevel::Error )
+        {
+            // never lose the message we are about to break on; once the writer
+            // has drained this ring there is room again
+            do
+            {
+                logger.Flush();
+            } while ( !ring.Push( level, fmt, args, fill ) );
+        }
+        else
+        {
+            // give the writer a moment to make room before giving up on it,
+            // a burst should not cost the logging thread more than that
+            logger.Wake();
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( MAX_WAIT_MS );
+            bool pushed = false;
+            while ( !pushed && std::chrono::steady_clock::now() < deadline )
+            {
+                std::this_thread::yield();
+                pushed = ring.Push( level, fmt, args, fill );
+            }
+            if ( !pushed )
+            {
+                ring.CountDropped();
+            }
+        }
+    }
+    va_end( args );
 
     if ( level >= LogLevel::Error )
     {
+        logger.Flush();
+#ifdef _WIN32
         __debugbreak();
+#else
+        std::raise( SIGTRAP );
+#endif
     }
 }
+
+void LogFlush()
+{
+    TheLogger().Flush();
+}
+
 }  // namespace internal
@@ -1,5 +1,10 @@
 #pragma once
 
+// Messages below LOG_MIN_LEVEL are compiled out, arguments included.
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 0
+#endif
+
 namespace internal {
 enum class LogLevel {
     Log = 0,
@@ -10,12 +15,29 @@ enum class LogLevel {
     Fatal,
 };
 
+// Formats the message into the calling thread's ring buffer and returns.
+// A background thread timestamps records and writes them to the sinks.
+// Error and Fatal records are never dropped and are flushed before returning;
+// lower levels wait briefly for room and are dropped (and counted) when the
+// ring stays full.
 void Log( LogLevel level, const char* fmt, ... );
+
+// Blocks until every record pushed so far has been written.
+void LogFlush();
 }  // namespace internal
 
-#define LOG( fmt, ... )  ::internal::Log( ::internal::LogLevel::Log, fmt, ##__VA_ARGS__ )
-#define LOGI( fmt, ... ) ::internal::Log( ::internal::LogLevel::Info, fmt, ##__VA_ARGS__ )
-#define LOGS( fmt, ... ) ::internal::Log( ::internal::LogLevel::Success, fmt, ##__VA_ARGS__ )
-#define LOGW( fmt, ... ) ::internal::Log( ::internal::LogLevel::Warning, fmt, ##__VA_ARGS__ )
-#define LOGE( fmt, ... ) ::internal::Log( ::internal::LogLevel::Error, fmt, ##__VA_ARGS__ )
-#define LOGF( fmt, ... ) ::internal::Log( ::internal::LogLevel::Fatal, fmt, ##__VA_ARGS__ )
\ No newline at end of file
+#define LOG_IMPL( level, fmt, ... )                                          \
+    do                                                                       \
+    {                                                                        \
+        if constexpr ( static_cast<int>( level ) >= LOG_MIN_LEVEL )          \
+        {                                                                    \
+            ::internal::Log( level, fmt, ##__VA_ARGS__ );                    \
+        }                                                                    \
+    } while ( 0 )
+
+#define LOG( fmt, ... )  LOG_IMPL( ::internal::LogLevel::Log, fmt, ##__VA_ARGS__ )
+#define LOGI( fmt, ... ) LOG_IMPL( ::internal::LogLevel::Info, fmt, ##__VA_ARGS__ )
+#define LOGS( fmt, ... ) LOG_IMPL( ::internal::LogLevel::Success, fmt, ##__VA_ARGS__ )
+#define LOGW( fmt, ... ) LOG_IMPL( ::internal::LogLevel::Warning, fmt, ##__VA_ARGS__ )
+#define LOGE( fmt, ... ) LOG_IMPL( ::internal::LogLevel::Error, fmt, ##__VA_ARGS__ )
+#define LOGF( fmt, ... ) LOG_IMPL( ::internal::LogLevel::Fatal, fmt, ##__VA_ARGS__ )
@@ -0,0 +1,36 @@
+#include "StringId.h"
+
+#include <cassert>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#ifndef NDEBUG
+static std::mutex s_registryLock;
+static std::unordered_map<uint64_t, std::string> s_registry;
+#endif
+
+StringId StringId::Intern( const char* str )
+{
+    StringId id;
+    id.mHash = Hash( str, std::strlen( str ) );
+
+#ifndef NDEBUG
+    std::lock_guard<std::mutex> lock( s_registryLock );
+    auto it = s_registry.emplace( id.mHash, str ).first;
+    assert( it->second == str && "StringId hash collision" );
+    id.mDebugName = it->second.c_str();
+#endif
+
+    return id;
+}
+
+const char* StringId::DebugName() const
+{
+#ifndef NDEBUG
+    return mDebugName;
+#else
+    return "<StringId>";
+#endif
+}
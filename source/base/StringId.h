@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// 64-bit FNV-1a hash of a string. Ids built from string literals are hashed
+// at compile time; runtime strings go through Intern. Debug builds also keep
+// the source string around so ids can be turned back into readable names,
+// which is for logging only.
+class StringId {
+   public:
+    static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+    static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+    static constexpr uint64_t Hash( const char* str, size_t length )
+    {
+        uint64_t hash = FNV_OFFSET_BASIS;
+        for ( size_t i = 0; i < length; ++i )
+        {
+            hash = ( hash ^ static_cast<uint8_t>( str[i] ) ) * FNV_PRIME;
+        }
+        return hash;
+    }
+
+    // characters before the terminator, a literal may be shorter than its array
+    static constexpr size_t Length( const char* str, size_t capacity )
+    {
+        size_t length = 0;
+        while ( length < capacity && str[length] != '\0' )
+        {
+            ++length;
+        }
+        return length;
+    }
+
+    constexpr StringId()
+        : mHash( 0 )
+#ifndef NDEBUG
+        , mDebugName( "" )
+#endif
+    {
+    }
+
+    // literals only: consteval rejects runtime buffers, which would hash
+    // their padding and leave the debug name dangling
+    template<size_t N>
+    consteval StringId( const char ( &str )[N] )
+        : mHash( Hash( str, Length( str, N ) ) )
+#ifndef NDEBUG
+        , mDebugName( str )
+#endif
+    {
+    }
+
+    // hashes a runtime string; debug builds copy it into a registry for reverse lookup
+    static StringId Intern( const char* str );
+
+    // returns the original string in debug builds and a placeholder otherwise,
+    // never use it for names the game relies on
+    const char* DebugName() const;
+
+    constexpr uint64_t Value() const { return mHash; }
+    constexpr bool IsValid() const { return mHash != 0; }
+
+    constexpr bool operator==( const StringId& rhs ) const { return mHash == rhs.mHash; }
+    constexpr bool operator!=( const StringId& rhs ) const { return mHash != rhs.mHash; }
+
+   private:
+    uint64_t mHash;
+#ifndef NDEBUG
+    const char* mDebugName;
+#endif
+};
+
+namespace std {
+template<>
+struct hash<StringId> {
+    size_t operator()( const StringId& id ) const
+    {
+        return static_cast<size_t>( id.Value() );
+    }
+};
+}  // namespace std
@@ -1,6 +1,12 @@
 #include "Geometry.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <future>
+#include <unordered_map>
+
+#include "base/FrameArena.h"
 
 using std::array;
 using std::vector;
@@ -24,38 +30,25 @@ Mesh& Mesh::MakeBox( const array<vec3, 8>& points, const vec3& color, float alph
 {
     mColor = vec4( color, alpha );
 
-    const vec3 vert0 = points[0];
-    const vec3 vert1 = points[1];
-    const vec3 vert2 = points[2];
-    const vec3 vert3 = points[3];
-    const vec3 vert4 = points[4];
-    const vec3 vert5 = points[5];
-    const vec3 vert6 = points[6];
-    const vec3 vert7 = points[7];
+    mPositions.assign( points.begin(), points.end() );
 
     // clang-format off
-    mPositions = {
+    mFaces = {
         // left
-        vert0, vert3, vert1, vert0, vert2, vert3,
+        uvec3( 0, 3, 1 ), uvec3( 0, 2, 3 ),
         // right
-        vert4, vert6, vert5, vert5, vert6, vert7,
+        uvec3( 4, 6, 5 ), uvec3( 5, 6, 7 ),
         // front
-        vert0, vert7, vert2, vert0, vert5, vert7,
+        uvec3( 0, 7, 2 ), uvec3( 0, 5, 7 ),
         // back
-        vert1, vert3, vert6, vert1, vert6, vert4,
+        uvec3( 1, 3, 6 ), uvec3( 1, 6, 4 ),
         // up
-        vert1, vert4, vert0, vert0, vert4, vert5,
+        uvec3( 1, 4, 0 ), uvec3( 0, 4, 5 ),
         // down
-        vert2, vert6, vert3, vert6, vert2, vert7,
+        uvec3( 2, 6, 3 ), uvec3( 6, 2, 7 ),
     };
     // clang-format on
 
-    mFaces.clear();
-    for ( int i = 0; i < 36; i += 3 )
-    {
-        mFaces.push_back( uvec3( i, i + 1, i + 2 ) );
-    }
-
     return *this;
 }
 
@@ -68,26 +61,30 @@ Mesh& Mesh::MakeCylinder( const vec3& color, float radius, float heightPerSeg, i
     mPositions.clear();
     mFaces.clear();
 
+    const int rowSize = radialSegments + 1;
+    mPositions.reserve( static_cast<size_t>( heightSegments + 1 ) * rowSize );
+    mFaces.reserve( static_cast<size_t>( heightSegments ) * radialSegments * 2 );
+
+    for ( int i = 0; i <= heightSegments; ++i )
+    {
+        const float y = ( i - heightSegments * 0.5f ) * heightPerSeg;
+        for ( int j = 0; j <= radialSegments; ++j )
+        {
+            const float angle = ( static_cast<float>( j ) / radialSegments ) * ( 2 * glm::pi<float>() );
+            mPositions.push_back( vec3( glm::sin( angle ) * radius, y, glm::cos( angle ) * radius ) );
+        }
+    }
+
     for ( int i = 0; i < heightSegments; ++i )
     {
         for ( int j = 0; j < radialSegments; ++j )
         {
-            const float angle1 = ( static_cast<float>( j ) / radialSegments ) * ( 2 * glm::pi<float>() );
-            const float angle2 = ( static_cast<float>( j + 1 ) / radialSegments ) * ( 2 * glm::pi<float>() );
-            const float y1 = ( i - heightSegments * 0.5f ) * heightPerSeg;
-            const float y2 = ( i - heightSegments * 0.5f ) * heightPerSeg + heightPerSeg;
-            const vec3 p1( glm::sin( angle1 ) * radius, y1, glm::cos( angle1 ) * radius );
-            const vec3 p2( glm::sin( angle2 ) * radius, y1, glm::cos( angle2 ) * radius );
-            const vec3 p3( glm::sin( angle1 ) * radius, y2, glm::cos( angle1 ) * radius );
-            const vec3 p4( glm::sin( angle2 ) * radius, y2, glm::cos( angle2 ) * radius );
-
-            mPositions.push_back( p1 );
-            mPositions.push_back( p2 );
-            mPositions.push_back( p3 );
-
-            mPositions.push_back( p2 );
-            mPositions.push_back( p4 );
-            mPositions.push_back( p3 );
+            const uint32_t p1 = i * rowSize + j;
+            const uint32_t p2 = p1 + 1;
+            const uint32_t p3 = p1 + rowSize;
+            const uint32_t p4 = p3 + 1;
+            mFaces.push_back( uvec3( p1, p2, p3 ) );
+            mFaces.push_back( uvec3( p2, p4, p3 ) );
         }
     }
 
@@ -129,51 +126,148 @@ Mesh& Mesh::RotateZ( float degree )
     return *this;
 }
 
-void MeshGroup::BuildBuffers( std::vector<Vertex>& outVertices ) const
+size_t Mesh::FaceCount() const
+{
+    return mFaces.empty() ? mPositions.size() / 3 : mFaces.size();
+}
+
+namespace {
+
+struct VertexHash {
+    size_t operator()( const Vertex& vertex ) const
+    {
+        // FNV-1a over the raw bytes, Vertex has no padding
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>( &vertex );
+        uint64_t hash = 14695981039346656037ull;
+        for ( size_t i = 0; i < sizeof( Vertex ); ++i )
+        {
+            hash = ( hash ^ bytes[i] ) * 1099511628211ull;
+        }
+        return static_cast<size_t>( hash );
+    }
+};
+
+struct VertexEqual {
+    bool operator()( const Vertex& a, const Vertex& b ) const
+    {
+        return std::memcmp( &a, &b, sizeof( Vertex ) ) == 0;
+    }
+};
+
+static_assert( sizeof( Vertex ) == 10 * sizeof( float ), "Vertex must not contain padding" );
+
+struct IndexedMesh {
+    vector<Vertex> vertices;
+    vector<uint32_t> indices;
+};
+
+}  // namespace
+
+void Mesh::BuildIndexed( vector<Vertex>& outVertices, vector<uint32_t>& outIndices ) const
 {
+    // sub meshes may be built on worker threads, so each thread gets its own scratch arena
+    thread_local FrameArena s_scratch( 256 * 1024 );
+    ScratchScope scope( s_scratch );
+
+    // transform every source position exactly once
+    ArenaVector<vec3> positions( mPositions.size(), vec3( 0.0f ), ArenaAllocator<vec3>( s_scratch ) );
+    for ( size_t i = 0; i < positions.size(); ++i )
+    {
+        positions[i] = vec3( mTrans * vec4( mPositions[i], 1.0f ) );
+    }
+
+    const size_t faceCount = FaceCount();
+    outIndices.resize( faceCount * 3 );
     outVertices.clear();
-    for ( const Mesh& mesh : mMeshes )
+    outVertices.reserve( std::min( faceCount * 3, positions.size() * 6 ) );
+
+    using LookupAllocator = ArenaAllocator<std::pair<const Vertex, uint32_t>>;
+    std::unordered_map<Vertex, uint32_t, VertexHash, VertexEqual, LookupAllocator> lookup( 0, VertexHash(), VertexEqual(), LookupAllocator( s_scratch ) );
+    lookup.reserve( outVertices.capacity() );
+
+    for ( size_t f = 0; f < faceCount; ++f )
     {
-        const mat4& M = mesh.mTrans;
-        if ( mesh.mFaces.size() )
+        const uvec3 face = mFaces.empty() ? uvec3( 3 * f, 3 * f + 1, 3 * f + 2 ) : mFaces[f];
+        const vec3& p0 = positions[face.x];
+        const vec3& p1 = positions[face.y];
+        const vec3& p2 = positions[face.z];
+
+        Vertex vertex;
+        vertex.color = mColor;
+        vertex.normal = glm::normalize( glm::cross( p2 - p1, p0 - p1 ) );
+
+        for ( int k = 0; k < 3; ++k )
         {
-            for ( const uvec3& face : mesh.mFaces )
+            vertex.position = positions[face[k]];
+            auto it = lookup.find( vertex );
+            if ( it == lookup.end() )
             {
-                const vec4 p0 = M * vec4( mesh.mPositions[face.x], 1.0f );
-                const vec4 p1 = M * vec4( mesh.mPositions[face.y], 1.0f );
-                const vec4 p2 = M * vec4( mesh.mPositions[face.z], 1.0f );
-                const vec3 normal = glm::normalize( glm::cross( vec3( p2 - p1 ), vec3( p0 - p1 ) ) );
-
-                Vertex vertex;
-                vertex.color = mesh.mColor;
-                vertex.normal = normal;
-                vertex.position = p0;
-                outVertices.push_back( vertex );
-                vertex.position = p1;
-                outVertices.push_back( vertex );
-                vertex.position = p2;
+                const uint32_t index = static_cast<uint32_t>( outVertices.size() );
+                it = lookup.emplace( vertex, index ).first;
                 outVertices.push_back( vertex );
             }
+            outIndices[3 * f + k] = it->second;
         }
-        else
+    }
+}
+
+void MeshGroup::BuildBuffers( ArenaVector<Vertex>& outVertices, ArenaVector<uint32_t>& outIndices ) const
+{
+    const size_t meshCount = mMeshes.size();
+    vector<IndexedMesh> parts( meshCount );
+
+    size_t faceCount = 0;
+    for ( const Mesh& mesh : mMeshes )
+    {
+        faceCount += mesh.FaceCount();
+    }
+
+    if ( faceCount >= PARALLEL_BUILD_FACES && meshCount > 1 )
+    {
+        vector<std::future<void>> tasks;
+        tasks.reserve( meshCount );
+        for ( size_t i = 0; i < meshCount; ++i )
         {
-            for ( size_t i = 0; i < mesh.mPositions.size(); i += 3 )
-            {
-                const vec4 p0 = M * vec4( mesh.mPositions.at( i + 0 ), 1.0f );
-                const vec4 p1 = M * vec4( mesh.mPositions.at( i + 1 ), 1.0f );
-                const vec4 p2 = M * vec4( mesh.mPositions.at( i + 2 ), 1.0f );
-                const vec3 normal = glm::normalize( glm::cross( vec3( p2 - p1 ), vec3( p0 - p1 ) ) );
-
-                Vertex vertex;
-                vertex.color = mesh.mColor;
-                vertex.normal = normal;
-                vertex.position = p0;
-                outVertices.push_back( vertex );
-                vertex.position = p1;
-                outVertices.push_back( vertex );
-                vertex.position = p2;
-                outVertices.push_back( vertex );
-            }
+            const Mesh* mesh = &mMeshes[i];
+            IndexedMesh* part = &parts[i];
+            tasks.push_back( std::async( std::launch::async, [mesh, part]() {
+                mesh->BuildIndexed( part->vertices, part->indices );
+            } ) );
+        }
+        for ( auto& task : tasks )
+        {
+            task.get();
+        }
+    }
+    else
+    {
+        for ( size_t i = 0; i < meshCount; ++i )
+        {
+            mMeshes[i].BuildIndexed( parts[i].vertices, parts[i].indices );
+        }
+    }
+
+    // concatenate into exactly sized buffers, rebasing indices per sub mesh
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    for ( const IndexedMesh& part : parts )
+    {
+        vertexCount += part.vertices.size();
+        indexCount += part.indices.size();
+    }
+
+    outVertices.clear();
+    outVertices.reserve( vertexCount );
+    outIndices.resize( indexCount );
+
+    size_t indexOffset = 0;
+    for ( const IndexedMesh& part : parts )
+    {
+        const uint32_t baseVertex = static_cast<uint32_t>( outVertices.size() );
+        outVertices.insert( outVertices.end(), part.vertices.begin(), part.vertices.end() );
+        for ( uint32_t index : part.indices )
+        {
+            outIndices[indexOffset++] = baseVertex + index;
         }
     }
 }
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include "MathHelper.h"
+#include "base/FrameArena.h"
 
 inline constexpr float DEFAULT_MESH_SIZE = 0.5f;
 
@@ -59,6 +60,8 @@ struct Mesh {
 
    private:
     void ApplyMatrix( const mat4& trans );
+    size_t FaceCount() const;
+    void BuildIndexed( std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices ) const;
 
     std::vector<vec3> mPositions;
     std::vector<uvec3> mFaces;
@@ -70,8 +73,16 @@ struct Mesh {
 
 class MeshGroup {
    public:
-    void BuildBuffers( std::vector<Vertex>& outVertices ) const;
+    // Builds an indexed triangle list. Vertices sharing position, normal and
+    // color are welded; groups above PARALLEL_BUILD_FACES faces are built on
+    // worker threads, one sub mesh per task. The buffers are only needed
+    // until they are uploaded, so they live in the caller's arena.
+    void BuildBuffers( ArenaVector<Vertex>& outVertices, ArenaVector<uint32_t>& outIndices ) const;
     inline void AddSubMesh( const Mesh& mesh ) { mMeshes.push_back( mesh ); }
+    inline void SetName( const std::string& name ) { mName = name; }
+    inline const std::string& Name() const { return mName; }
+
+    static constexpr size_t PARALLEL_BUILD_FACES = 4096;
 
    protected:
     std::vector<Mesh> mMeshes;
@@ -1,13 +1,92 @@
 #include "Node.h"
-using glm::mat4;
 
-mat4 Node::WorldTrans() const
+#include <algorithm>
+#include <cassert>
+
+SceneGraph::SceneGraph( StringId rootName )
+    : mAnyDirty( false )
+{
+    mParents.push_back( INVALID_NODE );
+    mLocalTrans.push_back( mat4( 1.0f ) );
+    mWorldTrans.push_back( mat4( 1.0f ) );
+    mDirty.push_back( 0 );
+    mNames.push_back( rootName );
+    mMeshKeys.push_back( StringId() );
+}
+
+void SceneGraph::Reserve( size_t count )
+{
+    mParents.reserve( count );
+    mLocalTrans.reserve( count );
+    mWorldTrans.reserve( count );
+    mDirty.reserve( count );
+    mNames.reserve( count );
+    mMeshKeys.reserve( count );
+}
+
+SceneGraph::NodeId SceneGraph::AddNode( StringId name, NodeId parent )
+{
+    assert( parent >= 0 && parent < static_cast<NodeId>( Count() ) );
+
+    const NodeId node = static_cast<NodeId>( Count() );
+    mParents.push_back( parent );
+    mLocalTrans.push_back( mat4( 1.0f ) );
+    mWorldTrans.push_back( mWorldTrans[parent] );
+    mDirty.push_back( 0 );
+    mNames.push_back( name );
+    mMeshKeys.push_back( StringId() );
+    return node;
+}
+
+SceneGraph::NodeId SceneGraph::FindNode( StringId name ) const
+{
+    auto it = std::find( mNames.begin(), mNames.end(), name );
+    if ( it == mNames.end() )
+    {
+        return INVALID_NODE;
+    }
+
+    return static_cast<NodeId>( it - mNames.begin() );
+}
+
+void SceneGraph::SetMeshKey( NodeId node, StringId meshKey )
+{
+    mMeshKeys[node] = meshKey;
+}
+
+void SceneGraph::SetLocalTrans( NodeId node, const mat4& trans )
+{
+    mLocalTrans[node] = trans;
+    mDirty[node] = 1;
+    mAnyDirty = true;
+}
+
+void SceneGraph::UpdateWorldTransforms()
 {
-    mat4 worldTrans = mTrans;
-    for ( const Node* cursor = this; cursor->mParent; cursor = cursor->mParent )
+    if ( !mAnyDirty )
+    {
+        return;
+    }
+
+    const size_t count = Count();
+
+    // parents precede children, so a dirty parent has already been resolved
+    // (and its flag forwarded) by the time we reach any of its children
+    if ( mDirty[0] )
+    {
+        mWorldTrans[0] = mLocalTrans[0];
+    }
+
+    for ( size_t i = 1; i < count; ++i )
     {
-        worldTrans = cursor->mParent->mTrans * worldTrans;
+        const NodeId parent = mParents[i];
+        if ( mDirty[i] | mDirty[parent] )
+        {
+            mWorldTrans[i] = mWorldTrans[parent] * mLocalTrans[i];
+            mDirty[i] = 1;
+        }
     }
 
-    return worldTrans;
+    std::fill( mDirty.begin(), mDirty.end(), uint8_t( 0 ) );
+    mAnyDirty = false;
 }
@@ -1,44 +1,46 @@
 #pragma once
-#include <memory>
-#include <string>
+#include <cstdint>
 #include <vector>
 
 #include "MathHelper.h"
+#include "base/StringId.h"
 
-class Node {
+// Flat scene graph. Nodes live in contiguous arrays in topological order:
+// a parent is always added before its children, so a single forward pass
+// over the arrays is enough to update every world transform.
+class SceneGraph {
    public:
-    using Ptr = std::shared_ptr<Node>;
-    using NodeList = std::vector<Ptr>;
-
-    Node( const char* name )
-        : mName( name )
-        , mParent( nullptr )
-    {
-        mTrans = mat4( 1.0f );
-    }
-
-    void SetMeshKey( const char* meshKey )
-    {
-        mMeshKey = std::string( meshKey );
-    }
-
-    void AppendChild( Ptr child )
-    {
-        mChildren.push_back( child );
-        child->mParent = this;
-    }
-
-    mat4 WorldTrans() const;
-
-    inline const mat4& Trans() const
-    {
-        return mTrans;
-    }
+    using NodeId = int32_t;
+    static constexpr NodeId INVALID_NODE = -1;
+
+    SceneGraph( StringId rootName );
+
+    NodeId AddNode( StringId name, NodeId parent );
+    NodeId FindNode( StringId name ) const;
+
+    void Reserve( size_t count );
+
+    void SetMeshKey( NodeId node, StringId meshKey );
+    void SetLocalTrans( NodeId node, const mat4& trans );
+    void UpdateWorldTransforms();
+
+    inline NodeId Root() const { return 0; }
+    inline size_t Count() const { return mParents.size(); }
+    inline NodeId Parent( NodeId node ) const { return mParents[node]; }
+    inline StringId Name( NodeId node ) const { return mNames[node]; }
+    inline StringId MeshKey( NodeId node ) const { return mMeshKeys[node]; }
+    inline const mat4& LocalTrans( NodeId node ) const { return mLocalTrans[node]; }
+    inline const mat4& WorldTrans( NodeId node ) const { return mWorldTrans[node]; }
 
    protected:
-    std::string mName;
-    std::string mMeshKey;
-    mat4 mTrans;
-    NodeList mChildren;
-    Node* mParent;
+    // hot data, touched by UpdateWorldTransforms
+    std::vector<NodeId> mParents;
+    std::vector<mat4> mLocalTrans;
+    std::vector<mat4> mWorldTrans;
+    std::vector<uint8_t> mDirty;
+    bool mAnyDirty;
+
+    // cold data
+    std::vector<StringId> mNames;
+    std::vector<StringId> mMeshKeys;
 };
@@ -1,6 +1,5 @@
 #include "Scene.h"
 
-#include <string>
 #include <unordered_map>
 
 using glm::mat4;
@@ -8,12 +7,11 @@ using glm::uvec3;
 using glm::vec3;
 using glm::vec4;
 using std::array;
-using std::string;
 using std::unordered_map;
 using std::vector;
 
-static unordered_map<string, MeshGroup> s_meshes;
-Node g_scene( SCENE_KEY_ROOT );
+static unordered_map<StringId, MeshGroup> s_meshes;
+SceneGraph g_scene( SCENE_KEY_ROOT );
 
 static void BuildAirplane();
 static void BuildOcean();
@@ -24,9 +22,9 @@ void InitMeshes()
     BuildOcean();
 }
 
-MeshGroup* FindMesh( const char* key )
+MeshGroup* FindMesh( StringId key )
 {
-    auto it = s_meshes.find( string( key ) );
+    auto it = s_meshes.find( key );
     if ( it == s_meshes.end() )
     {
         return nullptr;
@@ -37,18 +35,18 @@ MeshGroup* FindMesh( const char* key )
 
 void SetupScene()
 {
-    Node::Ptr airplane = std::make_unique<Node>( SCENE_KEY_AIRPLANE );
-    Node::Ptr airplanePropeller = std::make_unique<Node>( SCENE_KEY_AIRPLANE_PROPELLER );
-    airplanePropeller->SetMeshKey( MESH_KEY_AIRPLANE_PROPELLER );
-    Node::Ptr airplaneBody = std::make_unique<Node>( SCENE_KEY_AIRPLANE_BODY );
-    airplaneBody->SetMeshKey( MESH_KEY_AIRPLANE_BODY );
-    Node::Ptr ocean = std::make_unique<Node>( SCENE_KEY_OCEAN );
-    ocean->SetMeshKey( MESH_KEY_OCEAN );
-
-    airplane->AppendChild( airplaneBody );
-    airplane->AppendChild( airplanePropeller );
-    g_scene.AppendChild( airplane );
-    g_scene.AppendChild( ocean );
+    using NodeId = SceneGraph::NodeId;
+
+    NodeId airplane = g_scene.AddNode( SCENE_KEY_AIRPLANE, g_scene.Root() );
+    g_scene.SetLocalTrans( airplane, glm::translate( mat4( 1.0f ), vec3( 0.0f, 40.0f, 0.0f ) ) );
+    NodeId airplaneBody = g_scene.AddNode( SCENE_KEY_AIRPLANE_BODY, airplane );
+    g_scene.SetMeshKey( airplaneBody, MESH_KEY_AIRPLANE_BODY );
+    NodeId airplanePropeller = g_scene.AddNode( SCENE_KEY_AIRPLANE_PROPELLER, airplane );
+    g_scene.SetMeshKey( airplanePropeller, MESH_KEY_AIRPLANE_PROPELLER );
+    NodeId ocean = g_scene.AddNode( SCENE_KEY_OCEAN, g_scene.Root() );
+    g_scene.SetMeshKey( ocean, MESH_KEY_OCEAN );
+
+    g_scene.UpdateWorldTransforms();
 }
 
 static void BuildOcean()
@@ -63,6 +61,7 @@ static void BuildOcean()
     mesh.RotateX( 90.f );
     mesh.Translate( 0.0f, -radius, 100.0f );
     ocean.AddSubMesh( mesh );
+    ocean.SetName( "ocean" );
     s_meshes[MESH_KEY_OCEAN] = ocean;
 }
 
@@ -145,6 +144,7 @@ static void BuildAirplane()
             .Translate( -3.5f, -0.8f, 0.0f );
         ADD_AND_RESET_MESH;
 #undef ADD_AND_RESET_MESH
+        airplaneBody.SetName( "airplane.body" );
         s_meshes[MESH_KEY_AIRPLANE_BODY] = airplaneBody;
     }
 
@@ -168,6 +168,7 @@ static void BuildAirplane()
             .Translate( 6.8f, 0.0f, 0.0f );
         ADD_AND_RESET_MESH;
 #undef ADD_AND_RESET_MESH
+        airplanePropeller.SetName( "airplane.propeller" );
         s_meshes[MESH_KEY_AIRPLANE_PROPELLER] = airplanePropeller;
     }
 }
\ No newline at end of file
@@ -92,9 +92,15 @@ struct MeshGeometry {
     Microsoft::WRL::ComPtr<ID3D12Resource> VertexBufferGPU = nullptr;
     Microsoft::WRL::ComPtr<ID3D12Resource> VertexBufferUploader = nullptr;
 
+    Microsoft::WRL::ComPtr<ID3DBlob> IndexBufferCPU = nullptr;
+    Microsoft::WRL::ComPtr<ID3D12Resource> IndexBufferGPU = nullptr;
+    Microsoft::WRL::ComPtr<ID3D12Resource> IndexBufferUploader = nullptr;
+
     // Data about the buffers.
     uint32_t VertexByteStride = 0;
     uint32_t VertexBufferByteSize = 0;
+    DXGI_FORMAT IndexFormat = DXGI_FORMAT_R32_UINT;
+    uint32_t IndexBufferByteSize = 0;
     uint32_t IndexCount = 0;
 
     D3D12_VERTEX_BUFFER_VIEW VertexBufferView() const
@@ -107,10 +113,21 @@ struct MeshGeometry {
         return vbv;
     }
 
+    D3D12_INDEX_BUFFER_VIEW IndexBufferView() const
+    {
+        D3D12_INDEX_BUFFER_VIEW ibv;
+        ibv.BufferLocation = IndexBufferGPU->GetGPUVirtualAddress();
+        ibv.Format = IndexFormat;
+        ibv.SizeInBytes = IndexBufferByteSize;
+
+        return ibv;
+    }
+
     // We can free this memory after we finish upload to the GPU.
     void DisposeUploaders()
     {
         VertexBufferUploader = nullptr;
+        IndexBufferUploader = nullptr;
     }
 };
 
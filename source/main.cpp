@@ -5,6 +5,8 @@
 #include "UploadBuffer.h"
 #include "FrameResource.h"
 
+#include "base/FrameArena.h"
+#include "base/Log.h"
 #include "base/Utilities.h"
 #include "core/MainWindow.h"
 #include "core/MathHelper.h"
@@ -12,6 +14,7 @@
 #include "gfx/GfxContext.h"
 #include "gfx/PipelineStateObjects.h"
 
+#include <algorithm>
 #include <unordered_map>
 #include <WindowsX.h>
 
@@ -45,6 +48,9 @@ struct RenderItem {
     // Index into GPU constant buffer corresponding to the ObjectCB for this render item.
     UINT ObjCBIndex = -1;
 
+    // Scene graph node that owns the world transform of this render item.
+    SceneGraph::NodeId Node = SceneGraph::INVALID_NODE;
+
     // Primitive topology.
     D3D12_PRIMITIVE_TOPOLOGY PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 
@@ -162,6 +168,7 @@ class Application {
 
     void UpdateCamera();
     void UpdateObjectCBs();
+    void ReportFrameArena();
     void UpdateMainPassCB();
 
     void BuildDescriptorHeaps();
@@ -169,7 +176,7 @@ class Application {
     void BuildShapeGeometry();
     void BuildFrameResources();
     void BuildRenderItems();
-    void DrawRenderItems( ID3D12GraphicsCommandList* cmdList, const std::vector<std::unique_ptr<RenderItem>>& items );
+    void DrawRenderItems( ID3D12GraphicsCommandList* cmdList, const ArenaVector<const RenderItem*>& items );
 };
 
 LRESULT CALLBACK MainWndProc( HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam )
@@ -179,7 +186,7 @@ LRESULT CALLBACK MainWndProc( HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam
     return Application::GetApp()->MsgProc( hwnd, msg, wParam, lParam );
 }
 
-std::unordered_map<std::string, std::shared_ptr<MeshGeometry>> s_gpuMeshes;
+std::unordered_map<StringId, std::shared_ptr<MeshGeometry>> s_gpuMeshes;
 
 int main()
 {
@@ -229,6 +236,7 @@ int Application::Run()
 bool Application::Initialize()
 {
     InitMeshes();
+    SetupScene();
 
     if ( !Com_Window_Create( "TheAviator", 800, 600 ) )
     {
@@ -367,6 +375,10 @@ void Application::OnResize()
 
 void Application::Update()
 {
+    // everything allocated from the frame arena last frame is dead by now
+    ReportFrameArena();
+    g_frameArena.Reset();
+
     UpdateCamera();
 
     // Cycle through the circular frame resource array.
@@ -425,7 +437,21 @@ void Application::Draw()
     passCbvHandle.Offset( passCbvIndex, s_cbvSrvUavDescriptorSize );
     s_commandList->SetGraphicsRootDescriptorTable( 1, passCbvHandle );
 
-    DrawRenderItems( s_commandList, mRenderItems );
+    // draw list for this frame, grouped by geometry so buffers are bound once per mesh
+    ArenaVector<const RenderItem*> drawList( ArenaAllocator<const RenderItem*>( g_frameArena ) );
+    drawList.reserve( mRenderItems.size() );
+    for ( const auto& item : mRenderItems )
+    {
+        if ( item->IndexCount > 0 )
+        {
+            drawList.push_back( item.get() );
+        }
+    }
+    std::sort( drawList.begin(), drawList.end(), []( const RenderItem* a, const RenderItem* b ) {
+        return a->Geo.get() < b->Geo.get();
+    } );
+
+    DrawRenderItems( s_commandList, drawList );
 
     // Indicate a state transition on the resource usage.
     s_commandList->ResourceBarrier( 1, &CD3DX12_RESOURCE_BARRIER::Transition( CurrentBackBuffer(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT ) );
@@ -492,30 +518,41 @@ void Application::BuildDescriptorHeaps()
     DX_CALL( s_device->CreateDescriptorHeap( &cbvHeapDesc, IID_PPV_ARGS( &mCbvHeap ) ) );
 }
 
-static std::shared_ptr<MeshGeometry> BuildGeometry( ID3D12Device* device, ID3D12GraphicsCommandList* commandList, const char* key )
+static std::shared_ptr<MeshGeometry> BuildGeometry( ID3D12Device* device, ID3D12GraphicsCommandList* commandList, StringId key )
 {
     const MeshGroup* meshGroup = FindMesh( key );
-    vector<Vertex> vertices;
-    meshGroup->BuildBuffers( vertices );
+
+    // the cpu side buffers are copied into blobs below, so they can be scratch
+    ScratchScope scope( g_frameArena );
+    ArenaVector<Vertex> vertices( ArenaAllocator<Vertex>( g_frameArena ) );
+    ArenaVector<uint32_t> indices( ArenaAllocator<uint32_t>( g_frameArena ) );
+    meshGroup->BuildBuffers( vertices, indices );
 
     const uint32_t vbByteSize = static_cast<uint32_t>( vertices.size() * sizeof( vertices.front() ) );
+    const uint32_t ibByteSize = static_cast<uint32_t>( indices.size() * sizeof( indices.front() ) );
 
     std::shared_ptr<MeshGeometry> mesh = std::make_shared<MeshGeometry>();
-    mesh->Name = key;
+    mesh->Name = meshGroup->Name();
 
     DX_CALL( D3DCreateBlob( vbByteSize, &mesh->VertexBufferCPU ) );
     CopyMemory( mesh->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize );
     mesh->VertexBufferGPU = d3dUtil::CreateDefaultBuffer( device, commandList, vertices.data(), vbByteSize, mesh->VertexBufferUploader );
 
+    DX_CALL( D3DCreateBlob( ibByteSize, &mesh->IndexBufferCPU ) );
+    CopyMemory( mesh->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize );
+    mesh->IndexBufferGPU = d3dUtil::CreateDefaultBuffer( device, commandList, indices.data(), ibByteSize, mesh->IndexBufferUploader );
+
     mesh->VertexByteStride = sizeof( Vertex );
     mesh->VertexBufferByteSize = vbByteSize;
-    mesh->IndexCount = static_cast<uint32_t>( vertices.size() );
+    mesh->IndexFormat = DXGI_FORMAT_R32_UINT;
+    mesh->IndexBufferByteSize = ibByteSize;
+    mesh->IndexCount = static_cast<uint32_t>( indices.size() );
     return mesh;
 }
 
 void Application::BuildShapeGeometry()
 {
-    std::array<std::string, 3> meshKeys = {
+    const std::array<StringId, 3> meshKeys = {
         MESH_KEY_AIRPLANE_BODY,
         MESH_KEY_AIRPLANE_PROPELLER,
         MESH_KEY_OCEAN,
@@ -523,7 +560,7 @@ void Application::BuildShapeGeometry()
 
     for ( const auto& key : meshKeys )
     {
-        s_gpuMeshes[key] = BuildGeometry( s_device, s_commandList, key.c_str() );
+        s_gpuMeshes[key] = BuildGeometry( s_device, s_commandList, key );
     }
 }
 
@@ -585,65 +622,70 @@ void Application::BuildConstantBufferViews()
     }
 }
 
-void Application::DrawRenderItems( ID3D12GraphicsCommandList* cmdList, const std::vector<std::unique_ptr<RenderItem>>& items )
+void Application::DrawRenderItems( ID3D12GraphicsCommandList* cmdList, const ArenaVector<const RenderItem*>& items )
 {
-    const UINT objCBByteSize = (uint32_t)AlignUp( sizeof( ObjectConstants ), 256 );
-
-    auto objectCB = mCurrFrameResource->ObjectCB->Resource();
+    const MeshGeometry* boundGeo = nullptr;
 
     // For each render item...
-    // for ( size_t i = 0; i < 2; ++i )
-    for ( size_t i = 0; i < items.size(); ++i )
+    for ( const RenderItem* item : items )
     {
-        const auto& item = items[i];
-
-        const D3D12_VERTEX_BUFFER_VIEW view = item->Geo->VertexBufferView();
-        cmdList->IASetVertexBuffers( 0, 1, &item->Geo->VertexBufferView() );
+        if ( item->Geo.get() != boundGeo )
+        {
+            boundGeo = item->Geo.get();
+            const D3D12_VERTEX_BUFFER_VIEW vbv = boundGeo->VertexBufferView();
+            const D3D12_INDEX_BUFFER_VIEW ibv = boundGeo->IndexBufferView();
+            cmdList->IASetVertexBuffers( 0, 1, &vbv );
+            cmdList->IASetIndexBuffer( &ibv );
+        }
         cmdList->IASetPrimitiveTopology( item->PrimitiveType );
 
         // Offset to the CBV in the descriptor heap for this object and for this frame resource.
-        UINT cbvIndex = mCurrFrameResourceIndex * (UINT)items.size() + item->ObjCBIndex;
+        // The object CBVs are laid out for every render item, not just the drawn ones.
+        UINT cbvIndex = mCurrFrameResourceIndex * (UINT)mRenderItems.size() + item->ObjCBIndex;
         auto cbvHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE( mCbvHeap->GetGPUDescriptorHandleForHeapStart() );
         cbvHandle.Offset( cbvIndex, s_cbvSrvUavDescriptorSize );
 
         cmdList->SetGraphicsRootDescriptorTable( 0, cbvHandle );
 
-        // cmdList->DrawIndexedInstanced( item->IndexCount, 1, 0, 0, 0 );
-        cmdList->DrawInstanced( item->IndexCount, 1, 0, 0 );
+        cmdList->DrawIndexedInstanced( item->IndexCount, 1, item->StartIndexLocation, item->BaseVertexLocation, 0 );
     }
 }
 
 void Application::UpdateCamera()
 {
 }
+
+// logs the frame arena when its peak grows or a frame spilled to the heap
+void Application::ReportFrameArena()
+{
+    static size_t s_reportedPeak = 0;
+
+    const FrameArena::Stats& stats = g_frameArena.GetStats();
+    if ( stats.overflowAllocations > 0 )
+    {
+        LOGW( "frame arena spilled %zu allocations (%zu bytes used, capacity %zu)", stats.overflowAllocations, stats.bytesUsed, g_frameArena.Capacity() );
+    }
+    if ( stats.peakBytes > s_reportedPeak )
+    {
+        s_reportedPeak = stats.peakBytes;
+        LOG( "frame arena peak %zu bytes, %zu allocations this frame", stats.peakBytes, stats.allocations );
+    }
+}
 static float g_angle = 45.0f;
 void Application::UpdateObjectCBs()
 {
     g_angle -= 1.0f;
 
-    auto currObjectCB = mCurrFrameResource->ObjectCB.get();
+    static const SceneGraph::NodeId s_propeller = g_scene.FindNode( SCENE_KEY_AIRPLANE_PROPELLER );
+    g_scene.SetLocalTrans( s_propeller, glm::rotate( mat4( 1 ), glm::radians( g_angle ), vec3( 1, 0, 0 ) ) );
+    g_scene.UpdateWorldTransforms();
 
-    int i = 0;
-    for ( auto& e : mRenderItems )
+    auto currObjectCB = mCurrFrameResource->ObjectCB.get();
+    for ( const auto& item : mRenderItems )
     {
         ObjectConstants objConstants;
-        // TODO: remove hard code
-        if ( i == 1 )
-        {
-            objConstants.Model = glm::rotate( mat4( 1 ), glm::radians( g_angle ), vec3( 1, 0, 0 ) );
-        }
-        else
-        {
-            objConstants.Model = mat4( 1.0 );
-        }
-        if ( i != 2 )
-        {
-            objConstants.Model = glm::translate( mat4( 1 ), vec3( 0, 40, 0 ) ) * objConstants.Model;
-        }
-
-        currObjectCB->CopyData( e->ObjCBIndex, objConstants );
-
-        ++i;
+        objConstants.Model = g_scene.WorldTrans( item->Node );
+        currObjectCB->CopyData( item->ObjCBIndex, objConstants );
     }
 }
 
@@ -666,29 +708,22 @@ void Application::UpdateMainPassCB()
 void Application::BuildRenderItems()
 {
     uint32_t objCBIndex = 0;
+    for ( size_t i = 0; i < g_scene.Count(); ++i )
     {
-        auto body = std::make_unique<RenderItem>();
-        body->ObjCBIndex = objCBIndex++;
-        body->Geo = s_gpuMeshes[MESH_KEY_AIRPLANE_BODY];
-        body->IndexCount = body->Geo->IndexCount;
-        body->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-        mRenderItems.push_back( std::move( body ) );
-    }
-    {
-        auto propeller = std::make_unique<RenderItem>();
-        propeller->ObjCBIndex = objCBIndex++;
-        propeller->Geo = s_gpuMeshes[MESH_KEY_AIRPLANE_PROPELLER];
-        propeller->IndexCount = propeller->Geo->IndexCount;
-        propeller->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-        mRenderItems.push_back( std::move( propeller ) );
-    }
-    {
-        auto ocean = std::make_unique<RenderItem>();
-        ocean->ObjCBIndex = objCBIndex++;
-        ocean->Geo = s_gpuMeshes[MESH_KEY_OCEAN];
-        ocean->IndexCount = ocean->Geo->IndexCount;
-        ocean->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-        mRenderItems.push_back( std::move( ocean ) );
+        const SceneGraph::NodeId node = static_cast<SceneGraph::NodeId>( i );
+        const StringId meshKey = g_scene.MeshKey( node );
+        if ( !meshKey.IsValid() )
+        {
+            continue;
+        }
+
+        auto item = std::make_unique<RenderItem>();
+        item->ObjCBIndex = objCBIndex++;
+        item->Node = node;
+        item->Geo = s_gpuMeshes[meshKey];
+        item->IndexCount = item->Geo->IndexCount;
+        item->PrimitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+        mRenderItems.push_back( std::move( item ) );
     }
 }
 
@@ -12,18 +12,13 @@ const float BACKGROUND_COLOR1[] = { 228.0f/255.0f, 224.0f/255.0f, 186.0f/255.0f
 const float BACKGROUND_COLOR2[] = { 247.0f/255.0f, 217.0f/255.0f, 170.0f/255.0f };
 
 extern int WIDTH, HEIGHT, ACTUAL_WIDTH, ACTUAL_HEIGHT;
-extern float TIMER;
 
-extern float AMBIENT_LIGHT_INTENSITY;
 const float NEAR_PLANE = 1.0f, FAR_PLANE = 10000.0f;
 
 namespace GAME {
   extern float SPEED;
   extern float FPS;
   extern int DISPLAY_FPS;
-  extern float AIRPLANE_DISTANCE;
-  extern float MILES;
-  extern float HEALTH;
 };
 
 namespace SEA {
@@ -52,10 +47,26 @@ namespace LIGHT {
 };
 
 namespace SHADOW {
-  extern float NEAR_PLANE;
-  extern float FAR_PLANE;
+  // half the width of the shadow box around the airplane, and how far it
+  // reaches past the airplane away from the light
+  extern float DISTANCE;
+  extern float DEPTH;
   extern int WIDTH;
   extern int HEIGHT;
+  extern int DEPTH_BITS;
+  // frames between updates of the static (sea) and dynamic (caster) layers
+  extern int STATIC_INTERVAL;
+  extern int DYNAMIC_INTERVAL;
+  // PCF taps per receiver fragment: 1, 4, 9, or 16 for a Poisson disk
+  extern int KERNEL_TAPS;
+};
+
+// distance fog, from the camera to where it is opaque; the sea fades out
+// earlier so its edge never shows
+namespace FOG {
+  extern float START;
+  extern float END;
+  extern float SEA_END;
 };
 
 namespace AIRPLANE {
@@ -68,10 +79,59 @@ namespace AIRPLANE {
   extern float AMPHEIGHT;
 };
 
-extern float COLLISION_SPEED_X;
-extern float COLLISION_SPEED_Y;
-extern float COLLISION_DISPLACEMENT_X;
-extern float COLLISION_DISPLACEMENT_Y;
+namespace STRESS {
+  extern int ENABLED;
+  extern int STAGES;
+  extern float GROWTH;
+  extern int WARMUP_FRAMES;
+  extern int SAMPLE_FRAMES;
+  extern float OBSTACLE_MULTIPLIER;
+  extern float BATTERY_MULTIPLIER;
+  extern float CLOUD_MULTIPLIER;
+  extern float PARTICLE_MULTIPLIER;
+};
+
+// offscreen rendering without a window, set from the command line
+namespace HEADLESS {
+  extern int ENABLED;
+  extern int WIDTH;
+  extern int HEIGHT;
+  extern int FRAMES;
+  // golden comparison: per channel difference a pixel may have, and the
+  // share of pixels allowed above it
+  extern int TOLERANCE;
+  extern float MAX_MISMATCH_PERCENT;
+  extern const char* GOLDEN;
+  extern const char* OUTPUT;
+};
+
+// frame recording, set from the command line; OUTPUT is a raw rgb24 file,
+// or the file name prefix of a png sequence
+namespace CAPTURE {
+  extern const char* OUTPUT;
+  extern int PNG;
+  // every INTERVAL-th frame is captured
+  extern int INTERVAL;
+};
+
+// performance statistics, set from the command line; OUTPUT receives one
+// record per frame, OVERLAY shows the F3 overlay from the start
+namespace STATS {
+  extern const char* OUTPUT;
+  extern int OVERLAY;
+};
+
+// warns once the tracked memory exceeds BUDGET megabytes, 0 disables it
+namespace MEMORY {
+  extern int BUDGET;
+};
+
+namespace BATCH {
+  extern int SESSIONS;
+  extern int THREADS;
+  extern int TICKS;
+  extern int SEED;
+};
 
 class Entity;
 extern Entity* SEA_MODEL;
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <models/Geometry.h>
 #include <maths/Maths.h>
 #include <entities/gameObjects/ParticleHolder.h>
+#include <gameEngine/StressTest.h>
+#include <gameEngine/World.h>
 #include <common.h>
 #include <iostream>
 using std::cout;
@@ -20,7 +22,6 @@ DynamicEntity::DynamicEntity(
   type(type),
   lifespan(1),
   distance(0.0f),
-  originScale(scale),
   Entity(model, position, color, glm::vec3(scale), opacity, receiveShadow, castShadow)
 {}
 
@@ -29,7 +30,8 @@ DynamicEntity::~DynamicEntity() {
     removeEntity(this);
     // generate particle effects
     float density = type == OBSTACLE ? 15 : 8;
-    ParticleHolder::theOne().spawnParticles(position, density, color, (float) density * scale.x / 15.0f);
+    int particleNumber = StressTest::scale(density, STRESS_PARTICLES);
+    ParticleHolder::theOne().spawnParticles(position, particleNumber, color, (float) density * scale.x / 15.0f);
   }
 }
 
@@ -49,30 +51,13 @@ void DynamicEntity::setLifespan(int lifespan) {
   this->lifespan = lifespan;
 }
 
-void DynamicEntity::deplete() {
-  // change scale
-  scale = glm::vec3(originScale * (float)lifespan / (float)LIFESPAN);
-  // change velocity and position
-  velocity += glm::vec3(velocity.x > 0.0f ? -0.04f: 0.04f, -0.06f, 0.0f);
-  changePosition(velocity.x, velocity.y, velocity.z);
-  // rotate randomly
-  changeRotation(Maths::rand(0.0f, 12.0f), Maths::rand(0.0f, 12.0f), 0.0f);
-  if (lifespan)
-    lifespan--;
-}
-
-void DynamicEntity::setVelocity(glm::vec3 velocity) {
-  this->velocity = velocity;
-}
-
 EntityType DynamicEntity::getType() const {
   return type;
 }
 
-DynamicEntities dynamicEntities;
-
 void DynamicEntity::addEntity(DynamicEntity* entity) {
   RawModel* key = entity->getModel();
+  DynamicEntities& dynamicEntities = World::current().dynamicEntities;
   if (dynamicEntities.find(key) == dynamicEntities.end())
     dynamicEntities.insert(std::pair<RawModel*, vector<DynamicEntity*>>(key, vector<DynamicEntity*>()));
   dynamicEntities.at(key).push_back(entity);
@@ -80,6 +65,7 @@ void DynamicEntity::addEntity(DynamicEntity* entity) {
 
 void DynamicEntity::removeEntity(DynamicEntity* entity) {
   RawModel* key = entity->getModel();
+  DynamicEntities& dynamicEntities = World::current().dynamicEntities;
   if (dynamicEntities.find(key) != dynamicEntities.end()) {
     vector<DynamicEntity*>& entities = dynamicEntities[key];
     for (int i = 0; i < entities.size(); ++i) {
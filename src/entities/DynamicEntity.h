@@ -11,6 +11,8 @@ const float spawnChance_O = 0.3f;
 const float spawnChance_B = 0.5f;
 const float minHeight = 20.0f;
 const float maxHeight = 60.0f;
+// depth range for the extra copies spawned by the stress test
+const float stressSpread = 60.0f;
 
 enum EntityType {
   PARTICLE = 0,
@@ -21,10 +23,8 @@ enum EntityType {
 class DynamicEntity: public Entity {
 private:
   float distance; // distance is the angle relative to plane
-  glm::vec3 velocity;
   int lifespan;
   const EntityType type;
-  float originScale;
 public:
   DynamicEntity(
     EntityType type,
@@ -42,8 +42,6 @@ public:
   void setDistance(float distance);
   int getLifespan() const;
   void setLifespan(int lifespan);
-  void setVelocity(glm::vec3 velocity);
-  void deplete();
   EntityType getType() const;
 
   static void addEntity(DynamicEntity* entity);
@@ -51,4 +49,3 @@ public:
 };
 
 typedef std::map<RawModel*, std::vector<DynamicEntity*>> DynamicEntities;
-extern DynamicEntities dynamicEntities;
@@ -1,14 +1,23 @@
 // Entity.cc
 #include "Entity.h"
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <iostream>
+#include <entities/gameObjects/Camera.h>
 #include <maths/Maths.h>
 #include <maths/Object3D.h>
 #include <utils/Debug.h>
+#include <utils/MemoryTracker.h>
+#include <gameEngine/World.h>
+#include <unordered_set>
 
 using std::vector;
+using std::unordered_set;
 
-static int ID = 0;
+// entities are created by every world thread
+static std::atomic<unsigned int> ID(0);
 
 Entity::Entity()
     : id(ID++), rigidBody(nullptr), model(nullptr), position(glm::vec3(0.0f)),
@@ -46,6 +55,16 @@ Entity::~Entity() {
     delete rigidBody;
 }
 
+void* Entity::operator new(std::size_t size) {
+  MemoryTracker::theOne().allocate(MEMORY_ENTITIES, size);
+  return ::operator new(size);
+}
+
+void Entity::operator delete(void* pointer, std::size_t size) {
+  MemoryTracker::theOne().release(MEMORY_ENTITIES, size);
+  ::operator delete(pointer);
+}
+
 void Entity::updateTransformation(glm::mat4 transformationMatrix) {
   transformation = transformationMatrix * transformation;
   position.x = transformation[3].x;
@@ -103,6 +122,14 @@ void Entity::setColor(glm::vec3 color) { this->color = color; }
 
 glm::vec3 Entity::getScale() const { return scale; }
 
+int Entity::selectLod(int bias) const {
+  if (model->getLodCount() <= 1)
+    return 0;
+  float maxScale = std::max(std::abs(scale.x), std::max(std::abs(scale.y), std::abs(scale.z)));
+  float screenSize = Camera::primary().projectedSize(position, model->getBoundingRadius() * maxScale);
+  return model->selectLod(screenSize, bias);
+}
+
 void Entity::setScale(float dx, float dy, float dz) {
   scale = glm::vec3(dx, dy, dz);
 }
@@ -126,12 +153,24 @@ Object3D *Entity::getBody() {
 
 void Entity::setBody(Object3D *body) { this->rigidBody = body; }
 
-StaticEntities staticEntities;
-
 void Entity::addEntity(Entity *entity) {
   RawModel *key = entity->getModel();
+  StaticEntities &staticEntities = World::current().staticEntities;
   if (staticEntities.find(key) == staticEntities.end())
     staticEntities.insert(
         std::pair<RawModel *, vector<Entity *>>(key, vector<Entity *>()));
   staticEntities.at(key).push_back(entity);
 }
+
+void Entity::removeEntities(const vector<Entity *> &entities) {
+  // one pass per model instead of a linear search per entity
+  unordered_set<Entity *> removed(entities.begin(), entities.end());
+  for (auto &pair : World::current().staticEntities) {
+    vector<Entity *> &list = pair.second;
+    list.erase(std::remove_if(list.begin(), list.end(),
+                              [&removed](Entity *entity) {
+                                return removed.count(entity) != 0;
+                              }),
+               list.end());
+  }
+}
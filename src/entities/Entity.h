@@ -1,6 +1,7 @@
 // Entity.h
 #pragma once
 #include <glm/glm.hpp>
+#include <cstddef>
 #include <map>
 #include <models/RawModel.h>
 #include <vector>
@@ -29,6 +30,11 @@ public:
          bool castShadow = true);
   virtual ~Entity();
 
+  // entities on the heap are counted under MEMORY_ENTITIES, the virtual
+  // destructor gives delete the size of the derived class
+  static void* operator new(std::size_t size);
+  static void operator delete(void* pointer, std::size_t size);
+
   glm::vec3 getPosition() const;
   void setPosition(float dx, float dy, float dz);
   void changePosition(glm::mat4 translationMatrix);
@@ -46,6 +52,9 @@ public:
   glm::vec4 getWorldPos() const;
   void updatePrevTransformation();
 
+  // level of detail seen by the primary camera, made coarser by bias levels
+  int selectLod(int bias = 0) const;
+
   float getOpacity() const;
   RawModel *getModel() const;
   glm::vec3 getColor() const;
@@ -57,7 +66,7 @@ public:
   void setBody(Object3D *body);
 
   static void addEntity(Entity *entity);
+  static void removeEntities(const std::vector<Entity *> &entities);
 };
 
 typedef std::map<RawModel *, std::vector<Entity *>> StaticEntities;
-extern StaticEntities staticEntities;
@@ -1,83 +1,41 @@
 // Airplane.cc
 #include "Airplane.h"
-#include "Camera.h"
 #include <common.h>
+#include <gameEngine/World.h>
 #include <maths/Object3D.h>
 #include <maths/Maths.h>
 #include <utils/Debug.h>
-#include <io/MouseManager.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <algorithm>
 #include <iostream>
 using std::cout;
 using std::vector;
 
-float COLLISION_SPEED_X = 0;
-float COLLISION_SPEED_Y = 0;
-float COLLISION_DISPLACEMENT_X = 0;
-float COLLISION_DISPLACEMENT_Y = 0;
-
 const float PLANE_MIN_SPEED = 0.48f;
 const float PLANE_MAX_SPEED = 0.64f;
 
-glm::vec3 red(RED[0], RED[1], RED[2]);
-glm::vec3 white(WHITE[0], WHITE[1], WHITE[2]);
 glm::vec3 brown(BROWN[0], BROWN[1], BROWN[2]);
 glm::vec3 brownDark(BROWNDARK[0], BROWNDARK[1], BROWNDARK[2]);
-glm::vec3 pink(PINK[0], PINK[1], PINK[2]);
-
-vector<Entity*> Airplane::rigidBody;
 
 Airplane::Airplane() :
   speed(0.0f),
+  hairAngle(0.0f),
+  crashRotation(0.0f),
+  crashDrop(0.0f),
   axisX(glm::vec4(1.0f, 0.0f, 0.0f, 0.0f)),
   axisY(glm::vec4(0.0f, 1.0f, 0.0f, 0.0f)),
   axisZ(glm::vec4(0.0f, 0.0f, 1.0f, 0.0f)),
-  cockpit(Geometry::cockpit, glm::vec3(0.0f), red),
-  engine(Geometry::cube, glm::vec3(5.0f, 0.0f, 0.0f), white, glm::vec3(2.0f, 5.0f, 5.0f)),
-  tail(Geometry::cube, glm::vec3(-4.0f, 2.0f, 0.0f), red, glm::vec3(1.5f, 2.0f, 0.5f)),
-  sideWing(Geometry::cube, glm::vec3(0.0f, 1.5f, 0.0f), red, glm::vec3(3.0f, 0.5f, 12.0f)),
-  windShield(Geometry::cube, glm::vec3(0.5f, 2.7f, 0.0f), white, glm::vec3(0.3f, 1.5f, 2.0f), 0.3f),
+  hull(Geometry::airplane, glm::vec3(0.0f), glm::vec3(1.0f)),
   propeller(Geometry::propeller, glm::vec3(6.0f, 0.0f, 0.0f), brown, glm::vec3(2.0f, 1.0f, 1.0f)),
   blade1(Geometry::cube, glm::vec3(6.8f, 0.0f, 0.0f), brownDark, glm::vec3(0.1f, 8.0f, 1.0f)),
-  blade2(Geometry::cube, glm::vec3(6.8f, 0.0f, 0.0f), brownDark, glm::vec3(0.1f, 8.0f, 1.0f)),
-  wheelProtectionR(Geometry::cube, glm::vec3(2.5f, -2.0f, 2.5f), red, glm::vec3(3.0f, 1.5f, 1.0f)),
-  wheelProtectionL(Geometry::cube, glm::vec3(2.5f, -2.0f, -2.5f), red, glm::vec3(3.0f, 1.5f, 1.0f)),
-  tireR(Geometry::cube, glm::vec3(2.5f, -2.8f, 2.5f), brownDark, glm::vec3(2.4f, 2.4f, 0.4f)),
-  tireL(Geometry::cube, glm::vec3(2.5f, -2.8f, -2.5f), brownDark, glm::vec3(2.4f, 2.4f, 0.4f)),
-  wheelAxis(Geometry::cube, glm::vec3(2.5, -2.8f, 0.0f), brown, glm::vec3(1.0f, 1.0f, 6.0f)),
-  suspension(Geometry::cube, glm::vec3(-3.2f, 0.5f, 0.0f), red, glm::vec3(0.4f, 2.0f, 0.4f)),
-  tireB(Geometry::cube, glm::vec3(-3.5f, -0.5f, 0.0f), brownDark, glm::vec3(1.2f, 1.2f, 0.2f)),
-  wheelAxisB(Geometry::cube, glm::vec3(-3.5f, -0.5f, 0.0f), brown, glm::vec3(0.5f, 0.5f, 0.3f)),
-  body(Geometry::cube, glm::vec3(-0.8f, 1.5f, 0.0f), brown, glm::vec3(1.5f)),
-  face(Geometry::cube, glm::vec3(-1.0f, 2.7f, 0.0f), pink, glm::vec3(1.0f)),
-  hairSide(Geometry::cube, glm::vec3(-1.3f, 3.0f, 0.0f), brown, glm::vec3(1.2f, 0.4f, 1.2f)),
-  hairBack(Geometry::cube, glm::vec3(-1.6f, 2.8f, 0.0f), brown, glm::vec3(0.2f, 0.8f, 1.0f))
+  blade2(Geometry::cube, glm::vec3(6.8f, 0.0f, 0.0f), brownDark, glm::vec3(0.1f, 8.0f, 1.0f))
 {
-  components.push_back(&cockpit);
+  components.push_back(&hull);
   components.push_back(&propeller);
-  components.push_back(&engine);
-  components.push_back(&tail);
-  components.push_back(&sideWing);
-  components.push_back(&windShield);
   components.push_back(&blade1);
   components.push_back(&blade2);
-  components.push_back(&wheelProtectionR);
-  components.push_back(&wheelProtectionL);
-  components.push_back(&tireR);
-  components.push_back(&tireL);
-  components.push_back(&wheelAxis);
-  components.push_back(&suspension);
-  components.push_back(&tireB);
-  components.push_back(&wheelAxisB);
-  components.push_back(&body);
-  components.push_back(&face);
-  components.push_back(&hairSide);
-  components.push_back(&hairBack);
-
-  rigidBody.push_back(&cockpit);
-  cockpit.setBody(new Sphere(6.0f));
-  rigidBody.push_back(&engine);
+
+  hull.setBody(new Sphere(6.0f));
   // create hair
   for (int i = 0; i < 12; ++i) {
     int col = i % 3;
@@ -93,7 +51,6 @@ Airplane::Airplane() :
     Entity::addEntity(components[i]);
   }
 
-  suspension.changeRotation(glm::vec3(0.0f, 0.0f, 1.0f), -0.3f);
   blade2.changeRotation(glm::vec3(axisX), glm::radians(90.0f));
   translate(AIRPLANE::X, AIRPLANE::Y, AIRPLANE::Z);
 }
@@ -121,7 +78,6 @@ void Airplane::translate(float dx, float dy, float dz) {
 }
 
 void Airplane::updateHair() {
-  static float hairAngle = 0.0f;
   for (int i = 0; i < 12; ++i) {
     float height = 0.3f + glm::cos(hairAngle + i / 3) * 0.1f;
     float dy = (height - hair[i].getScale().y) / 2;
@@ -133,23 +89,22 @@ void Airplane::updateHair() {
 }
 
 void Airplane::update() {
-  if (GAME::HEALTH <= 0.0f) {
-    static float totalRotation = 0.0f;
-    static float y = 0.0f;
+  World& world = World::current();
+  if (world.health <= 0.0f) {
     const float zRotation = 0.3f;
-    totalRotation += zRotation;
-    y += 0.01f;
-    if (y <= 2.0f)
-      translate(0.0f, -y, 0.0f);
-    if (totalRotation < 80.0f)
+    crashRotation += zRotation;
+    crashDrop += 0.01f;
+    if (crashDrop <= 2.0f)
+      translate(0.0f, -crashDrop, 0.0f);
+    if (crashRotation < 80.0f)
       rotate(0.0f, 0.0f, -glm::radians(zRotation), position);
   } else {
-    speed = Maths::clamp(MouseManager::getX(), -0.5f, 0.5f, PLANE_MIN_SPEED, PLANE_MAX_SPEED);
-    float targetX = Maths::clamp(MouseManager::getX(), -1.0f, 1.0f, -AIRPLANE::AMPWIDTH, -0.7f * AIRPLANE::AMPWIDTH);
-    float targetY = Maths::clamp(MouseManager::getY(), -0.75f, 0.75f, AIRPLANE::Y - AIRPLANE::AMPHEIGHT, AIRPLANE::Y + AIRPLANE::AMPHEIGHT);
+    speed = Maths::clamp(world.inputX, -0.5f, 0.5f, PLANE_MIN_SPEED, PLANE_MAX_SPEED);
+    float targetX = Maths::clamp(world.inputX, -1.0f, 1.0f, -AIRPLANE::AMPWIDTH, -0.7f * AIRPLANE::AMPWIDTH);
+    float targetY = Maths::clamp(world.inputY, -0.75f, 0.75f, AIRPLANE::Y - AIRPLANE::AMPHEIGHT, AIRPLANE::Y + AIRPLANE::AMPHEIGHT);
 
-    COLLISION_DISPLACEMENT_X += COLLISION_SPEED_X;
-    targetX += COLLISION_DISPLACEMENT_X;
+    world.collisionDisplacementX += world.collisionSpeedX;
+    targetX += world.collisionDisplacementX;
 
     float deltaX = targetX - position.x;
     float deltaY = targetY - position.y;
@@ -160,10 +115,10 @@ void Airplane::update() {
     rotation.z = targetRotationZ;
 
 
-    COLLISION_SPEED_X += -COLLISION_DISPLACEMENT_X * 0.2f;
-    if (COLLISION_SPEED_X > 0)
-      COLLISION_DISPLACEMENT_X = 0;
-    COLLISION_DISPLACEMENT_X += -COLLISION_DISPLACEMENT_X * 0.1f;
+    world.collisionSpeedX += -world.collisionDisplacementX * 0.2f;
+    if (world.collisionSpeedX > 0)
+      world.collisionDisplacementX = 0;
+    world.collisionDisplacementX += -world.collisionDisplacementX * 0.1f;
   }
 
   // update hair
@@ -172,22 +127,23 @@ void Airplane::update() {
   blade1.changeRotation(glm::vec3(axisX), glm::radians(10.0f));
   blade2.changeRotation(glm::vec3(axisX), glm::radians(10.0f));
   propeller.changeRotation(glm::vec3(axisX), glm::radians(10.0f));
-  // move camera
-  Camera::primary().chasePoint(position);
-} 
+}
 
 void Airplane::knockBack(glm::vec3 otherPosition) {
   glm::vec3 distance = position - otherPosition;
   float length = glm::length(distance);
-  COLLISION_SPEED_X = 20.0f * distance.x / length;
-  AMBIENT_LIGHT_INTENSITY = 2.0f;
+  World::current().collisionSpeedX = 20.0f * distance.x / length;
+  World::current().ambientLightIntensity = 2.0f;
 }
 
 Entity& Airplane::getBody() {
-  return cockpit;
+  return hull;
+}
+
+glm::vec3 Airplane::getPosition() const {
+  return position;
 }
 
 Airplane& Airplane::theOne() {
-  static Airplane airplane;
-  return airplane;
+  return *World::current().airplane;
 }
@@ -13,30 +13,15 @@ private:
   glm::vec4 axisX, axisY, axisZ;
   std::vector<Entity*> components;
   float speed;
+  float hairAngle;
+  float crashRotation, crashDrop;
 
-  // plane
-  Entity cockpit;
-  Entity engine;
-  Entity tail;
-  Entity sideWing;
-  Entity windShield;
+  // the rigid parts of the plane and the pilot are baked into one model
+  Entity hull;
+  // animated parts
   Entity propeller;
   Entity blade1;
   Entity blade2;
-  Entity wheelProtectionR;
-  Entity wheelProtectionL;
-  Entity tireR;
-  Entity tireL;
-  Entity wheelAxis;
-  Entity suspension;
-  Entity tireB;
-  Entity wheelAxisB;
-
-  // pilot
-  Entity body;
-  Entity face;
-  Entity hairSide;
-  Entity hairBack;
   Entity hair[12];
 
 public:
@@ -48,8 +33,8 @@ public:
   void translate(float dx, float dy, float dz);
   void update();
   Entity& getBody();
+  glm::vec3 getPosition() const;
   void knockBack(glm::vec3 otherPosition);
 
   static Airplane& theOne();
-  static std::vector<Entity*> rigidBody;
 };
@@ -1,9 +1,11 @@
 // BatteryHolder.cc
 #include "BatteryHolder.h"
 #include <common.h>
+#include <gameEngine/World.h>
 #include <maths/Object3D.h>
 #include <maths/Maths.h>
 #include <models/Geometry.h>
+#include <gameEngine/StressTest.h>
 #include <iostream>
 using std::vector;
 
@@ -22,33 +24,39 @@ void BatteryHolder::spawn(float distance) {
     lastSpawnDistance = distance;
     if (!Maths::chance(spawnChance_B))
       return;
-    int batteryNumber = 1 + Maths::rand(0, 10);
-    float h = Maths::rand(minHeight, maxHeight) + SEA::RADIUS;
-    for (int i = 0; i < batteryNumber; ++i) {
-      float angle = offscreenLeft + i * 0.02f;
-      float height = h + glm::cos((float)i * 0.2f) * 5.0f;
-      glm::vec3 position(height * glm::sin(angle), height * glm::cos(angle) - SEA::RADIUS, 0.0f);
-      float scale = 2.0f;
-      DynamicEntity* battery = new DynamicEntity(
-        BATTERY,
-        Geometry::tetrahedron,
-        position,
-        batteryColor,
-        scale
-      );
-      battery->changeRotation(i * 0.1f, i * 0.1f, 0.0f);
-      battery->setBody(new Sphere(scale));
-      battery->setDistance(distance + i * 0.03f);
-      batteries.push_back(battery);
-      DynamicEntity::addEntity(battery);
+    int lineNumber = StressTest::scale(1, STRESS_BATTERIES);
+    for (int line = 0; line < lineNumber; ++line) {
+      // only the first line stays in the plane's flight path
+      float z = line ? Maths::rand(-stressSpread, stressSpread) : 0.0f;
+      int batteryNumber = 1 + Maths::rand(0, 10);
+      float h = Maths::rand(minHeight, maxHeight) + SEA::RADIUS;
+      for (int i = 0; i < batteryNumber; ++i) {
+        float angle = offscreenLeft + i * 0.02f;
+        float height = h + glm::cos((float)i * 0.2f) * 5.0f;
+        glm::vec3 position(height * glm::sin(angle), height * glm::cos(angle) - SEA::RADIUS, z);
+        float scale = 2.0f;
+        DynamicEntity* battery = new DynamicEntity(
+          BATTERY,
+          Geometry::tetrahedron,
+          position,
+          batteryColor,
+          scale
+        );
+        battery->changeRotation(i * 0.1f, i * 0.1f, 0.0f);
+        battery->setBody(new Sphere(scale));
+        battery->setDistance(distance + i * 0.03f);
+        batteries.push_back(battery);
+        DynamicEntity::addEntity(battery);
+      }
     }
   }
 }
 
 void BatteryHolder::update() {
-  spawn(GAME::AIRPLANE_DISTANCE);
+  float distance = World::current().airplaneDistance;
+  spawn(distance);
   for (int i = 0; i < batteries.size(); ++i) {
-    if (batteries[i]->getDistance() + offscreenRight < GAME::AIRPLANE_DISTANCE || !batteries[i]->getLifespan()) {
+    if (batteries[i]->getDistance() + offscreenRight < distance || !batteries[i]->getLifespan()) {
       delete batteries[i];
       batteries.erase(batteries.begin() + i);
       --i;
@@ -61,7 +69,10 @@ void BatteryHolder::update() {
   }
 }
 
+int BatteryHolder::getCount() const {
+  return batteries.size();
+}
+
 BatteryHolder& BatteryHolder::theOne() {
-  static BatteryHolder batteryHolder;
-  return batteryHolder;
+  return *World::current().batteryHolder;
 }
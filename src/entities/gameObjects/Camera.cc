@@ -5,7 +5,10 @@
 #include <io/KeyboardManager.h>
 #include <maths/Maths.h>
 #include <io/MouseManager.h>
+#include <entities/gameObjects/Airplane.h>
+#include <gameEngine/World.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
 #include <iostream>
 using std::cout;
 
@@ -14,6 +17,7 @@ Camera::Camera() {
   up = glm::vec3(0.0f, 1.0f, 0.0f);
   front = glm::vec3(0.0f, 0.0f, -1.0f);
   fov = CAMERA::FOV;
+  lightSpaceMatrix = glm::mat4(1.0f);
 }
 
 void Camera::changePosition(float degree) {
@@ -50,11 +54,34 @@ glm::mat4 Camera::getPVMatrix() {
   return getProjectionMatrix() * getViewMatrix();
 }
 
-glm::mat4 Camera::getLightSpaceMatrix() {
+glm::mat4 Camera::getLightSpaceMatrix() const {
+  return lightSpaceMatrix;
+}
+
+float Camera::shadowDepthRange() {
+  return SHADOW::DISTANCE + SHADOW::DEPTH;
+}
+
+void Camera::updateLightSpaceMatrix() {
   glm::vec3 lightPos(Light::theOne().getPosition());
-  glm::mat4 viewMatrix = glm::lookAt(lightPos, glm::vec3(AIRPLANE::X, AIRPLANE::Y, AIRPLANE::Z), glm::vec3(0.0f, 1.0f, 0.0f));
-  glm::mat4 projectionMatrix = glm::perspective(glm::radians(getFov()), (float) ACTUAL_WIDTH / (float) ACTUAL_HEIGHT, SHADOW::NEAR_PLANE, SHADOW::FAR_PLANE);
-  return projectionMatrix * viewMatrix;
+  glm::mat4 lightView = glm::lookAt(lightPos, glm::vec3(AIRPLANE::X, AIRPLANE::Y, AIRPLANE::Z), glm::vec3(0.0f, 1.0f, 0.0f));
+
+  // shadows only show up close to the airplane, so the box is a fixed size
+  // around it: the texel size never changes, and snapping the origin to whole
+  // texels keeps shadow edges still while the airplane moves
+  glm::vec3 center = glm::vec3(lightView * glm::vec4(World::current().airplane->getPosition(), 1.0f));
+  float extent = 2.0f * SHADOW::DISTANCE;
+  glm::vec2 texel = glm::vec2(extent) / glm::vec2(SHADOW::WIDTH, SHADOW::HEIGHT);
+  glm::vec2 lo = glm::floor((glm::vec2(center) - glm::vec2(SHADOW::DISTANCE)) / texel) * texel;
+  glm::vec2 hi = lo + glm::vec2(extent);
+
+  // the light looks down -z. The depth range is fixed too, so receivers can
+  // bias by world distances; it reaches SHADOW::DEPTH past the airplane, down
+  // to the sea below it, and casters nearer the light are depth clamped
+  float nearZ = center.z + SHADOW::DISTANCE;
+  float farZ = nearZ - shadowDepthRange();
+  glm::mat4 lightProjection = glm::ortho(lo.x, hi.x, lo.y, hi.y, -nearZ, -farZ);
+  lightSpaceMatrix = lightProjection * lightView;
 }
 
 float Camera::getFov() const {
@@ -85,6 +112,13 @@ glm::vec2 Camera::screenPos(glm::vec4 worldPos) {
   return glm::vec2(x, y);
 }
 
+float Camera::projectedSize(glm::vec3 center, float radius) const {
+  float distance = glm::length(center - position);
+  if (distance <= radius)
+    return 1.0f;
+  return radius / (distance * tanf(glm::radians(fov) * 0.5f));
+}
+
 Camera& Camera::primary() {
   static Camera primary;
   return primary;
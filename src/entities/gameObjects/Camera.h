@@ -12,6 +12,8 @@ private:
   glm::vec3 up;
 
   float fov;
+  // fitted once per frame by updateLightSpaceMatrix
+  glm::mat4 lightSpaceMatrix;
 public:
   Camera();
 
@@ -21,7 +23,11 @@ public:
   glm::mat4 getViewMatrix();
   glm::mat4 getPVMatrix();
 
-  glm::mat4 getLightSpaceMatrix();
+  // fits an orthographic light projection of fixed size around the airplane
+  void updateLightSpaceMatrix();
+  glm::mat4 getLightSpaceMatrix() const;
+  // world units covered by the shadow map's depth, the same every frame
+  static float shadowDepthRange();
 
   float getFov() const;
   void setFov(float fov);
@@ -29,6 +35,8 @@ public:
   void chasePoint(glm::vec3 position);
 
   glm::vec2 screenPos(glm::vec4 worldPos);
+  // height of a bounding sphere on screen, as a fraction of the screen height
+  float projectedSize(glm::vec3 center, float radius) const;
 
   static Camera& primary();
 };
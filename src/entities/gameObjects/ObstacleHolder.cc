@@ -2,9 +2,11 @@
 #include "ObstacleHolder.h"
 #include <maths/Object3D.h>
 #include <common.h>
+#include <gameEngine/World.h>
 #include <utils/Debug.h>
 #include <maths/Maths.h>
 #include <models/Geometry.h>
+#include <gameEngine/StressTest.h>
 #include <iostream>
 
 glm::vec3 obstacleColor(RED[0], RED[1], RED[2]);
@@ -22,27 +24,33 @@ void ObstacleHolder::spawn(float distance) {
     lastSpawnDistance = distance;
     if (!Maths::chance(spawnChance_O))
       return;
-    float h = Maths::rand(minHeight, maxHeight) + SEA::RADIUS;
-    glm::vec3 position(h * glm::sin(offscreenLeft), h * glm::cos(offscreenLeft) - SEA::RADIUS, 0.0f);
-    float scale = 3.0f;
-    DynamicEntity* obstacle = new DynamicEntity(
-      OBSTACLE,
-      Geometry::sphere,
-      position,
-      obstacleColor,
-      scale
-    );
-    obstacle->setBody(new Sphere(scale));
-    obstacle->setDistance(distance);
-    obstatcles.push_back(obstacle);
-    DynamicEntity::addEntity(obstacle);
+    int obstacleNumber = StressTest::scale(1, STRESS_OBSTACLES);
+    for (int i = 0; i < obstacleNumber; ++i) {
+      // only the first obstacle stays in the plane's flight path
+      float z = i ? Maths::rand(-stressSpread, stressSpread) : 0.0f;
+      float h = Maths::rand(minHeight, maxHeight) + SEA::RADIUS;
+      glm::vec3 position(h * glm::sin(offscreenLeft), h * glm::cos(offscreenLeft) - SEA::RADIUS, z);
+      float scale = 3.0f;
+      DynamicEntity* obstacle = new DynamicEntity(
+        OBSTACLE,
+        Geometry::sphere,
+        position,
+        obstacleColor,
+        scale
+      );
+      obstacle->setBody(new Sphere(scale));
+      obstacle->setDistance(distance);
+      obstatcles.push_back(obstacle);
+      DynamicEntity::addEntity(obstacle);
+    }
   }
 }
 
 void ObstacleHolder::update() {
-  spawn(GAME::AIRPLANE_DISTANCE);
+  float distance = World::current().airplaneDistance;
+  spawn(distance);
   for (int i = 0; i < obstatcles.size(); ++i) {
-    if (obstatcles[i]->getDistance() + offscreenRight < GAME::AIRPLANE_DISTANCE || !obstatcles[i]->getLifespan()) {
+    if (obstatcles[i]->getDistance() + offscreenRight < distance || !obstatcles[i]->getLifespan()) {
       delete obstatcles[i];
       obstatcles.erase(obstatcles.begin() + i);
       --i;
@@ -55,7 +63,10 @@ void ObstacleHolder::update() {
   }
 }
 
+int ObstacleHolder::getCount() const {
+  return obstatcles.size();
+}
+
 ObstacleHolder& ObstacleHolder::theOne() {
-  static ObstacleHolder obstacleHolder;
-  return obstacleHolder;
+  return *World::current().obstacleHolder;
 }
@@ -12,6 +12,7 @@ public:
 
   void spawn(float distance);
   void update();
+  int getCount() const;
 
   static ObstacleHolder& theOne();
 };
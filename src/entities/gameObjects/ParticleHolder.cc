@@ -1,54 +1,88 @@
 // ParticleHolder.cc
 #include "ParticleHolder.h"
-#include <maths/Object3D.h>
+#include <common.h>
+#include <gameEngine/World.h>
 #include <maths/Maths.h>
-#include <models/Geometry.h>
+#include <gameEngine/StressTest.h>
+#include <utils/MemoryTracker.h>
+#include <algorithm>
+#include <cmath>
 using std::vector;
 
-vector<DynamicEntity*> ParticleHolder::particles;
+int ParticleHolder::maxCapacity() {
+  // enough room for the busiest stress stage
+  int stage = STRESS::STAGES - 1;
+  float spawners = std::max(StressTest::multiplier(STRESS_OBSTACLES, stage),
+                            StressTest::multiplier(STRESS_BATTERIES, stage));
+  float scale = std::max(1.0f, spawners * StressTest::multiplier(STRESS_PARTICLES, stage));
+  return (int)std::min((float)MAX_STRESS_PARTICLES, MAX_PARTICLES * std::ceil(scale));
+}
 
-ParticleHolder::ParticleHolder() {}
+ParticleHolder::ParticleHolder():
+  capacity(maxCapacity()),
+  head(0),
+  count(0),
+  dirtyBegin(0),
+  dirtyCount(0)
+{
+  records.resize(capacity);
+  MemoryTracker::theOne().allocate(MEMORY_PARTICLES, capacity * sizeof(ParticleRecord));
+}
 
-ParticleHolder::~ParticleHolder() {}
+ParticleHolder::~ParticleHolder() {
+  MemoryTracker::theOne().release(MEMORY_PARTICLES, capacity * sizeof(ParticleRecord));
+}
 
 void ParticleHolder::spawnParticles(glm::vec3 position, int density, glm::vec3 color, float scale) {
   for (int i = 0; i < density; ++i) {
-    DynamicEntity* particle = new DynamicEntity(
-      PARTICLE,
-      Geometry::tetrahedron,
-      position,
-      color,
-      Maths::rand(0.4f, 0.7f) * scale,
-      1.0f,
-      false,
-      true
-    );
-    particle->setLifespan(LIFESPAN);
-    particle->setBody(new Sphere(scale));
-    glm::vec3 velocity = glm::vec3(Maths::rand(-1.2f, 1.4f), Maths::rand(-0.5f, 1.5f), 0.0f);
-    particle->setVelocity(velocity);
-    particles.push_back(particle);
+    ParticleRecord& record = records[head];
+    record.origin = position;
+    record.velocity = glm::vec3(Maths::rand(-1.2f, 1.4f), Maths::rand(-0.5f, 1.5f), 0.0f);
+    record.color = color;
+    record.scale = Maths::rand(0.4f, 0.7f) * scale;
+    record.spawnTime = World::current().timer;
+    if (!dirtyCount)
+      dirtyBegin = head;
+    head = (head + 1) % capacity;
+    // a full ring recycles the oldest record
+    count = std::min(count + 1, capacity);
+    dirtyCount = std::min(dirtyCount + 1, capacity);
   }
 }
 
 void ParticleHolder::update() {
-  for (int i = 0; i < particles.size(); ++i) {
-    DynamicEntity* particle = particles[i];
-    particle->deplete();
-    if (particle->getLifespan())
-      continue;
-    // remove particle
-    delete particle;
-    particles.erase(particles.begin() + i);
-    --i;
+  // all particles share LIFESPAN, so the oldest ones are always at the tail
+  float timer = World::current().timer;
+  while (count && timer - records[getTail()].spawnTime >= LIFESPAN) {
+    --count;
   }
 }
 
-ParticleHolder& ParticleHolder::theOne() {
-  static ParticleHolder particleHolder;
-  return particleHolder;
+const vector<ParticleRecord>& ParticleHolder::getRecords() const {
+  return records;
 }
 
-vector<DynamicEntity*>& ParticleHolder::getParticles() {
-  return particles;
+int ParticleHolder::getCapacity() const {
+  return capacity;
+}
+
+int ParticleHolder::getTail() const {
+  return (head - count + capacity) % capacity;
+}
+
+int ParticleHolder::getCount() const {
+  return count;
+}
+
+bool ParticleHolder::consumeDirtyRange(int& begin, int& count) {
+  if (!dirtyCount)
+    return false;
+  begin = dirtyCount == capacity ? head : dirtyBegin;
+  count = dirtyCount;
+  dirtyCount = 0;
+  return true;
+}
+
+ParticleHolder& ParticleHolder::theOne() {
+  return *World::current().particleHolder;
 }
@@ -2,9 +2,29 @@
 #pragma once
 #include <entities/DynamicEntity.h>
 
+const int MAX_PARTICLES = 4096;
+// upper bound on the ring when the stress test scales particle counts up
+const int MAX_STRESS_PARTICLES = 1 << 20;
+
+// everything the vertex shader needs to evaluate a particle at any tick
+struct ParticleRecord {
+  glm::vec3 origin;
+  glm::vec3 velocity;
+  glm::vec3 color;
+  float scale;
+  float spawnTime;
+};
+
 class ParticleHolder {
 private:
-  static std::vector<DynamicEntity*> particles;
+  // ring buffer, live records are [tail, head)
+  std::vector<ParticleRecord> records;
+  int capacity;
+  int head;
+  int count;
+  // records written since the last upload, starting at dirtyBegin
+  int dirtyBegin;
+  int dirtyCount;
 public:
   ParticleHolder();
   ~ParticleHolder();
@@ -12,6 +32,12 @@ public:
   void spawnParticles(glm::vec3 position, int denstiy, glm::vec3 color, float scale);
   void update();
 
+  const std::vector<ParticleRecord>& getRecords() const;
+  int getCapacity() const;
+  int getTail() const;
+  int getCount() const;
+  bool consumeDirtyRange(int& begin, int& count);
+
+  static int maxCapacity();
   static ParticleHolder& theOne();
-  static std::vector<DynamicEntity*>& getParticles();
 };
@@ -5,16 +5,18 @@
 
 class Entity;
 
+const int BASE_CLOUD_COUNT = 20;
+
+// a baked cloud model, spinning around its own center
 class Cloud {
 private:
-  glm::vec3 position;
-  std::vector<Entity*> clouds;
+  Entity* entity;
   float rotationSpeed;
 public:
-  Cloud();
+  Cloud(Entity* entity);
   ~Cloud();
 
-  void add(Entity* entity);
+  Entity* getEntity() const;
   void rotate(float dx, float dy, float dz, glm::vec3 center);
   void translate(float dx, float dy, float dz);
   void rotateEntity();
@@ -29,7 +31,11 @@ public:
   ~Sky();
 
   void createCloud(float angle);
+  void clear();
   void update();
 
+  int getCloudCount() const;
+  void setCloudCount(int count);
+
   static Sky& theOne();
 };
@@ -0,0 +1,121 @@
+// BatchRunner.cc
+#include "BatchRunner.h"
+#include "World.h"
+#include <common.h>
+#include <maths/Maths.h>
+#include <entities/gameObjects/Airplane.h>
+#include <utils/MemoryTracker.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+using std::cout;
+using std::vector;
+
+const char* BATCH_REPORT_FILE = "../batch_report.csv";
+// how far ahead of the plane the autopilot looks
+const float LOOKAHEAD = 80.0f;
+const float DODGE_HEIGHT = 15.0f;
+
+struct SessionResult {
+  int seed;
+  int ticks;
+  float distance;
+  float health;
+  int obstaclesHit;
+  int batteriesCollected;
+};
+
+// steers towards the closest battery ahead and away from the closest obstacle
+void autopilot(World& world) {
+  glm::vec3 plane = world.airplane->getPosition();
+  const DynamicEntity* target = nullptr;
+  for (auto& entry : world.dynamicEntities) {
+    for (const DynamicEntity* entity : entry.second) {
+      glm::vec3 position = entity->getPosition();
+      float ahead = position.x - plane.x;
+      // only the flight path matters, the stress copies live at other depths
+      if (!entity->getType() || ahead < 0.0f || ahead > LOOKAHEAD || glm::abs(position.z) > 10.0f)
+        continue;
+      if (!target || ahead < target->getPosition().x - plane.x)
+        target = entity;
+    }
+  }
+
+  float targetY = AIRPLANE::Y;
+  if (target) {
+    float y = target->getPosition().y;
+    if (target->getType() == OBSTACLE)
+      targetY = plane.y > y ? y + DODGE_HEIGHT : y - DODGE_HEIGHT;
+    else
+      targetY = y;
+  }
+  world.inputX = 0.0f;
+  world.inputY = Maths::clamp(targetY, AIRPLANE::Y - AIRPLANE::AMPHEIGHT, AIRPLANE::Y + AIRPLANE::AMPHEIGHT, -0.75f, 0.75f);
+}
+
+SessionResult runSession(int seed) {
+  World world(seed);
+  World::makeCurrent(&world);
+  SessionResult result = { seed, 0, 0.0f, 0.0f, 0, 0 };
+  while (result.ticks < BATCH::TICKS && world.health > 0.0f) {
+    autopilot(world);
+    world.tick();
+    ++result.ticks;
+  }
+  result.distance = world.airplaneDistance;
+  result.health = world.health;
+  result.obstaclesHit = world.obstaclesHit;
+  result.batteriesCollected = world.batteriesCollected;
+  // the world is destroyed after this, when it is no longer current; that is
+  // safe because ~World makes itself current again for its own teardown
+  World::makeCurrent(nullptr);
+  return result;
+}
+
+void BatchRunner::run() {
+  int threadCount = BATCH::THREADS > 0 ? BATCH::THREADS : std::max(1u, std::thread::hardware_concurrency());
+  threadCount = std::min(threadCount, BATCH::SESSIONS);
+  cout << "BATCH: " << BATCH::SESSIONS << " sessions of " << BATCH::TICKS
+       << " ticks on " << threadCount << " threads\n";
+
+  vector<SessionResult> results(BATCH::SESSIONS);
+  std::atomic<int> next(0);
+  auto start = std::chrono::steady_clock::now();
+
+  vector<std::thread> threads;
+  for (int i = 0; i < threadCount; ++i) {
+    threads.push_back(std::thread([&results, &next]() {
+      int session;
+      while ((session = next++) < BATCH::SESSIONS) {
+        results[session] = runSession(BATCH::SEED + session);
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::ofstream report(BATCH_REPORT_FILE);
+  if (!report.is_open()) {
+    cout << "==================================================\n";
+    cout << "ERROR::BATCH: Failed to open file " << BATCH_REPORT_FILE << "\n";
+    cout << "==================================================\n";
+    return;
+  }
+  report << "seed,ticks,distance,health,obstacles_hit,batteries_collected\n";
+  long long totalTicks = 0;
+  for (const SessionResult& result : results) {
+    report << result.seed << "," << result.ticks << "," << result.distance << "," << result.health << ","
+           << result.obstaclesHit << "," << result.batteriesCollected << "\n";
+    totalTicks += result.ticks;
+  }
+  cout << "BATCH: " << totalTicks << " ticks in " << seconds << " s ("
+       << totalTicks / seconds << " ticks/s), report written to " << BATCH_REPORT_FILE << "\n";
+  // peaks cover all sessions ticking at once
+  MemoryTracker::theOne().report();
+}
@@ -0,0 +1,8 @@
+// BatchRunner.h
+#pragma once
+
+// ticks BATCH::SESSIONS autopilot sessions without a window, one world
+// per session, spread over BATCH::THREADS threads
+namespace BatchRunner {
+  void run();
+};
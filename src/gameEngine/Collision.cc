@@ -6,6 +6,7 @@
 #include <models/Geometry.h>
 #include <entities/DynamicEntity.h>
 #include <entities/gameObjects/Airplane.h>
+#include <gameEngine/World.h>
 #include <iostream>
 #include <vector>
 #include <algorithm>
@@ -23,17 +24,20 @@ bool overlap(Object3D* o1, Object3D* o2) {
 }
 
 void Collision::checkCollisionAgainstPlane() {
+  World& world = World::current();
   // check all dynamic entities except particles
-  for (auto& entry: dynamicEntities) {
+  for (auto& entry: world.dynamicEntities) {
     vector<DynamicEntity*>& entities = entry.second;
     for (int i = 0; i < entities.size(); ++i) {
       DynamicEntity* entity = entities[i];
       if (entity->getType() && overlap(entity->getBody(), Airplane::theOne().getBody().getBody())) {
         if (entity->getType() == OBSTACLE) {
           Airplane::theOne().knockBack(entity->getPosition());
-          GAME::HEALTH = std::max(0.0f, GAME::HEALTH - 10.0f);
+          world.health = std::max(0.0f, world.health - 10.0f);
+          ++world.obstaclesHit;
         } else {
-          GAME::HEALTH = std::min(100.0f, GAME::HEALTH + 1.0f);
+          world.health = std::min(100.0f, world.health + 1.0f);
+          ++world.batteriesCollected;
         }
         entity->setLifespan(0);
       }
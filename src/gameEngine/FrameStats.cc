@@ -0,0 +1,183 @@
+// FrameStats.cc
+#include "FrameStats.h"
+#include "World.h"
+#include <common.h>
+#include <entities/gameObjects/Sky.h>
+#include <entities/gameObjects/ObstacleHolder.h>
+#include <entities/gameObjects/BatteryHolder.h>
+#include <entities/gameObjects/ParticleHolder.h>
+#include <renderEngine/GLState.h>
+#include <utils/MemoryTracker.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+using std::cout;
+using std::vector;
+
+static FrameStats::Frame emptyFrame() {
+  FrameStats::Frame stats;
+  stats.drawCalls = 0;
+  stats.triangles = 0;
+  stats.uniformUploads = 0;
+  stats.stateSubmitted = stats.stateFiltered = 0;
+  stats.obstacles = stats.batteries = stats.clouds = stats.particles = stats.entities = 0;
+  stats.staticShadow = stats.dynamicShadow = 0;
+  stats.memoryLive = stats.memoryPeak = stats.memoryGpu = 0;
+  stats.simTime = stats.renderTime = stats.frameTime = stats.gpuTime = 0.0;
+  stats.gpuFrame = -1;
+  return stats;
+}
+
+FrameStats::FrameStats():
+  current(emptyFrame()),
+  last(emptyFrame()),
+  frame(0),
+  historyNext(0),
+  overlay(STATS::OVERLAY != 0),
+  json(false)
+{
+  if (!STATS::OUTPUT)
+    return;
+
+  std::string fileName(STATS::OUTPUT);
+  json = fileName.size() >= 5 && fileName.compare(fileName.size() - 5, 5, ".json") == 0;
+  output.open(fileName);
+  if (!output.is_open()) {
+    cout << "==================================================\n";
+    cout << "ERROR::STATS: Failed to open file " << fileName;
+    cout << "\n==================================================\n";
+    return;
+  }
+  if (!json) {
+    // pass times only go to json, the set of passes changes from frame to frame
+    output << "frame,frame_ms,sim_ms,render_ms,gpu_frame,gpu_ms,draw_calls,triangles,uniform_uploads,"
+           << "state_changes,state_filtered,obstacles,batteries,clouds,particles,entities,memory_kb,memory_peak_kb,"
+           << "static_shadow,dynamic_shadow\n";
+  }
+}
+
+FrameStats& FrameStats::theOne() {
+  static FrameStats stats;
+  return stats;
+}
+
+void FrameStats::addDraw(long long triangles) {
+  ++current.drawCalls;
+  current.triangles += triangles;
+}
+
+void FrameStats::addUniform() {
+  ++current.uniformUploads;
+}
+
+void FrameStats::addShadowLayers(bool staticLayer, bool dynamicLayer) {
+  current.staticShadow += staticLayer;
+  current.dynamicShadow += dynamicLayer;
+}
+
+void FrameStats::setPassTimes(const vector<std::pair<std::string, double>>& passTimes, int gpuFrame) {
+  current.passTimes = passTimes;
+  current.gpuFrame = gpuFrame;
+  current.gpuTime = 0.0;
+  for (auto& pass : passTimes)
+    current.gpuTime += pass.second;
+}
+
+void FrameStats::endFrame(double simTime, double renderTime, double frameTime) {
+  const GLState::Stats& state = GLState::theOne().getFrameStats();
+  current.stateSubmitted = state.submitted;
+  current.stateFiltered = state.filtered;
+  current.obstacles = ObstacleHolder::theOne().getCount();
+  current.batteries = BatteryHolder::theOne().getCount();
+  current.clouds = Sky::theOne().getCloudCount();
+  current.particles = ParticleHolder::theOne().getCount();
+  current.entities = World::current().countEntities();
+  MemoryTracker& memory = MemoryTracker::theOne();
+  current.memoryLive = memory.getTotalLive();
+  current.memoryPeak = memory.getTotalPeak();
+  current.memoryGpu = memory.getLive(MEMORY_GPU_BUFFERS) + memory.getLive(MEMORY_TEXTURES) +
+                      memory.getLive(MEMORY_FRAMEBUFFERS);
+  current.simTime = 1000.0 * simTime;
+  current.renderTime = 1000.0 * renderTime;
+  current.frameTime = 1000.0 * frameTime;
+
+  if ((int)history.size() < HISTORY)
+    history.push_back(current.frameTime);
+  else
+    history[historyNext] = current.frameTime;
+  historyNext = (historyNext + 1) % HISTORY;
+  if (overlay) {
+    sorted = history;
+    std::sort(sorted.begin(), sorted.end());
+  }
+
+  if (output.is_open())
+    writeFrame(current);
+  ++frame;
+  last = current;
+  current = emptyFrame();
+}
+
+void FrameStats::writeFrame(const Frame& stats) {
+  if (!json) {
+    output << frame << "," << stats.frameTime << "," << stats.simTime << "," << stats.renderTime << ","
+           << stats.gpuFrame << "," << stats.gpuTime << "," << stats.drawCalls << "," << stats.triangles << ","
+           << stats.uniformUploads << ","
+           << stats.stateSubmitted << "," << stats.stateFiltered << "," << stats.obstacles << ","
+           << stats.batteries << "," << stats.clouds << "," << stats.particles << "," << stats.entities << ","
+           << (stats.memoryLive >> 10) << "," << (stats.memoryPeak >> 10) << "," << stats.staticShadow << ","
+           << stats.dynamicShadow << "\n";
+    return;
+  }
+  output << "{\"frame\":" << frame << ",\"frame_ms\":" << stats.frameTime << ",\"sim_ms\":" << stats.simTime
+         << ",\"render_ms\":" << stats.renderTime << ",\"gpu_frame\":" << stats.gpuFrame
+         << ",\"gpu_ms\":" << stats.gpuTime
+         << ",\"draw_calls\":" << stats.drawCalls << ",\"triangles\":" << stats.triangles
+         << ",\"uniform_uploads\":" << stats.uniformUploads << ",\"state_changes\":" << stats.stateSubmitted
+         << ",\"state_filtered\":" << stats.stateFiltered << ",\"obstacles\":" << stats.obstacles
+         << ",\"batteries\":" << stats.batteries << ",\"clouds\":" << stats.clouds
+         << ",\"particles\":" << stats.particles << ",\"entities\":" << stats.entities
+         << ",\"memory_kb\":" << (stats.memoryLive >> 10) << ",\"memory_peak_kb\":" << (stats.memoryPeak >> 10)
+         << ",\"static_shadow\":" << stats.staticShadow << ",\"dynamic_shadow\":" << stats.dynamicShadow
+         << ",\"gpu_passes\":{";
+  for (int i = 0; i < stats.passTimes.size(); ++i) {
+    // pass names are plain identifiers with spaces, nothing to escape
+    output << (i ? "," : "") << "\"" << stats.passTimes[i].first << "\":" << stats.passTimes[i].second;
+  }
+  output << "}}\n";
+}
+
+void FrameStats::toggleOverlay() {
+  overlay = !overlay;
+}
+
+bool FrameStats::isOverlayVisible() const {
+  return overlay;
+}
+
+bool FrameStats::isActive() const {
+  return overlay || output.is_open();
+}
+
+int FrameStats::getFrame() const {
+  return frame;
+}
+
+const FrameStats::Frame& FrameStats::getLastFrame() const {
+  return last;
+}
+
+vector<double> FrameStats::getHistory() const {
+  if ((int)history.size() < HISTORY)
+    return history;
+  vector<double> ordered(history.begin() + historyNext, history.end());
+  ordered.insert(ordered.end(), history.begin(), history.begin() + historyNext);
+  return ordered;
+}
+
+double FrameStats::getPercentile(double fraction) const {
+  if (sorted.empty())
+    return 0.0;
+  int index = std::max(0, (int)std::ceil(fraction * sorted.size()) - 1);
+  return sorted[std::min(index, (int)sorted.size() - 1)];
+}
@@ -0,0 +1,70 @@
+// FrameStats.h
+#pragma once
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// per frame render counters and timings. They back the overlay toggled with
+// F3 and are streamed to STATS::OUTPUT, as csv or as one json object per
+// line when the file name ends in .json
+class FrameStats {
+public:
+  // frame times kept for the graph and the percentiles
+  static const int HISTORY = 240;
+
+  struct Frame {
+    int drawCalls;
+    long long triangles;
+    int uniformUploads;
+    int stateSubmitted, stateFiltered;
+    int obstacles, batteries, clouds, particles, entities;
+    // shadow layers redrawn this frame, 0 or 1 each
+    int staticShadow, dynamicShadow;
+    // tracked bytes, see MemoryTracker
+    long long memoryLive, memoryPeak, memoryGpu;
+    // milliseconds
+    double simTime, renderTime, frameTime;
+    // gpu times arrive a few frames late, they belong to frame gpuFrame, -1
+    // when none landed
+    int gpuFrame;
+    double gpuTime;
+    std::vector<std::pair<std::string, double>> passTimes;
+  };
+
+private:
+  Frame current, last;
+  int frame;
+  std::vector<double> history;
+  int historyNext;
+  std::vector<double> sorted;
+  bool overlay;
+  bool json;
+  std::ofstream output;
+
+  FrameStats();
+  void writeFrame(const Frame& stats);
+public:
+  static FrameStats& theOne();
+
+  void addDraw(long long triangles);
+  void addUniform();
+  void addShadowLayers(bool staticLayer, bool dynamicLayer);
+  // gpu times of an earlier frame, see Frame::gpuFrame
+  void setPassTimes(const std::vector<std::pair<std::string, double>>& passTimes, int gpuFrame);
+  // closes the current frame, times in seconds
+  void endFrame(double simTime, double renderTime, double frameTime);
+
+  void toggleOverlay();
+  bool isOverlayVisible() const;
+  // the gpu timers only run while something consumes them
+  bool isActive() const;
+
+  // index of the frame being recorded, as written to the output
+  int getFrame() const;
+  const Frame& getLastFrame() const;
+  // frame times in milliseconds, oldest first
+  std::vector<double> getHistory() const;
+  // fraction in (0, 1] of the frames in the history, e.g. 0.95 for p95
+  double getPercentile(double fraction) const;
+};
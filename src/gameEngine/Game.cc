@@ -1,22 +1,23 @@
 // Game.cc
 #include "Game.h"
-#include "Collision.h"
+#include "FrameStats.h"
+#include "StressTest.h"
+#include "World.h"
 #include <common.h>
-#include <maths/Maths.h>
-#include <entities/Entity.h>
 #include <entities/gameObjects/Light.h>
-#include <entities/gameObjects/Sky.h>
 #include <entities/gameObjects/Airplane.h>
-#include <entities/gameObjects/ObstacleHolder.h>
-#include <entities/gameObjects/BatteryHolder.h>
-#include <entities/gameObjects/ParticleHolder.h>
 #include <entities/gameObjects/Camera.h>
 #include <models/Geometry.h>
 #include <renderEngine/DisplayManager.h>
+#include <renderEngine/GLState.h>
+#include <renderEngine/GpuResources.h>
+#include <shaders/ShaderCompiler.h>
+#include <io/KeyboardManager.h>
 #include <io/MouseManager.h>
-#include <io/Parser.h>
+#include <utils/MemoryTracker.h>
 #include <glm/glm.hpp>
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 using std::cout;
 
@@ -28,32 +29,100 @@ using std::cout;
 #undef max
 #endif
 
-float GAME::AIRPLANE_DISTANCE = 0.0f;
-float GAME::MILES = 0.0f;
-float GAME::HEALTH = 100.0f;
-float TIMER = 0;
-
-/* Helper function declaration */
-void updateFPSCount(double& previousSecond, int& updates);
-
 Game::Game() {
   currentTime = 0;
-  lastTime = DisplayManager::getTime();
-  previousSecond = lastTime;
+  lastTime = 0;
+  previousSecond = 0;
   delta = 0;
   updates = 0;
 }
 
 Game::~Game() {
-  DisplayManager::cleanDisplay();
-  Geometry::cleanGeometry();
+  if (!renderer)
+    return;
+  // the singletons the renderer uses may already be gone, leaking is all
+  // that is safe here
+  cout << "==================================================\n";
+  cout << "WARNING::GAME: Game::shutdown() was not called before exit";
+  cout << "\n==================================================\n";
+  renderer.release();
+  world.release();
 }
 
-void Game::init() {
-  Parser::parse();
-  DisplayManager::createDisplay();
-  Geometry::initGeometry();
+bool Game::init() {
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now(), mark = start;
+  auto phase = [&mark]() {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double milliseconds = std::chrono::duration<double, std::milli>(now - mark).count();
+    mark = now;
+    return milliseconds;
+  };
+
+  Geometry::generateGeometry();
+  if (!DisplayManager::createDisplay()) {
+    Geometry::waitGeometry();
+    // the display may be half created
+    DisplayManager::cleanDisplay();
+    return false;
+  }
+  ShaderCompiler::theOne().init();
+  // built before the game so it is destroyed after it, handles released
+  // during static destruction still find it
+  GpuResources::theOne();
+  double contextTime = phase();
+
+  // programs are only submitted here, the driver compiles them while the
+  // meshes are uploaded
+  Game& game = theOne();
+  game.renderer.reset(new Renderer());
+  double submitTime = phase();
+
+  Geometry::waitGeometry();
+  double waitTime = phase();
+  Geometry::uploadGeometry();
+  ShaderCompiler::theOne().poll();
+  double uploadTime = phase();
+
+  game.renderer->init();
+  game.world.reset(new World());
+  World::makeCurrent(game.world.get());
   Light::theOne().setPosition(LIGHT::X, LIGHT::Y, LIGHT::Z);
+  FrameStats::theOne();
+  if (STRESS::ENABLED)
+    StressTest::theOne().start();
+  ShaderCompiler::theOne().poll();
+  double systemTime = phase();
+  ShaderCompiler::theOne().finishAll();
+  double shaderTime = phase();
+
+  ShaderCompiler& compiler = ShaderCompiler::theOne();
+  double total = std::chrono::duration<double, std::milli>(mark - start).count();
+  cout << "STARTUP: context " << contextTime << " ms, shader submit " << submitTime << " ms, waiting for meshes "
+       << waitTime << " ms, upload " << uploadTime << " ms, systems " << systemTime << " ms, shader finish "
+       << shaderTime << " ms, total " << total << " ms; " << compiler.getCompletedInBackground() << " of "
+       << compiler.getSubmitted() << " programs finished in the background"
+       << (compiler.isParallel() ? "" : " (no parallel compile extension)") << "; meshes took " << Geometry::getGenerationTime() << " ms on " << Geometry::getGenerationThreads()
+       << " threads\n";
+
+  game.lastTime = DisplayManager::getTime();
+  game.previousSecond = game.lastTime;
+  return true;
+}
+
+void Game::shutdown() {
+  Game& game = theOne();
+  if (!game.renderer)
+    return;
+  MemoryTracker::theOne().report();
+  game.renderer->clean();
+  game.world.reset();
+  World::makeCurrent(nullptr);
+  // the programs are deleted while the context still exists
+  game.renderer.reset();
+  // models release their buffers, the pool is emptied while the context exists
+  Geometry::cleanGeometry();
+  GpuResources::theOne().clean();
+  DisplayManager::cleanDisplay();
 }
 
 Game& Game::theOne() {
@@ -63,36 +132,39 @@ Game& Game::theOne() {
 
 void Game::run() {
     if (shouldUpdate()) {
-      // temporary code for updating game angle
-      GAME::AIRPLANE_DISTANCE += GAME::SPEED;
-
+      long double frameStart = DisplayManager::getTime();
       MouseManager::update();
+      world->inputX = MouseManager::getX();
+      world->inputY = MouseManager::getY();
       Camera::primary().update();
       Light::theOne().update();
       DisplayManager::prepareDisplay();
+      KeyboardManager::update();
+      if (KeyboardManager::isKeyPressed(KEY_F3))
+        FrameStats::theOne().toggleOverlay();
 
-      // update light intensity
-      AMBIENT_LIGHT_INTENSITY = glm::max(1.0f, AMBIENT_LIGHT_INTENSITY - 0.05f);
-      // check collision
-      Collision::checkCollisionAgainstPlane();
-      ParticleHolder::theOne().update();
+      world->beginTick();
 
-      renderer.render();
+      long double renderStart = DisplayManager::getTime();
+      renderer->render();
+      long double renderTime = DisplayManager::getTime() - renderStart;
 
-      ObstacleHolder::theOne().update();
-      BatteryHolder::theOne().update();
-      Sky::theOne().update();
-      Airplane::theOne().update();
+      world->endTick();
+      Camera::primary().chasePoint(Airplane::theOne().getPosition());
+      renderStart = DisplayManager::getTime();
       DisplayManager::updateDisplay();
-
-      // update health
-      GAME::HEALTH -= 0.025f;
-      GAME::HEALTH = Maths::clamp(-0.1f, GAME::HEALTH, 100.0f);
+      renderTime += DisplayManager::getTime() - renderStart;
+      GLState::theOne().endFrame();
+      GpuResources::theOne().endFrame();
       ++updates;
+
+      long double frameTime = DisplayManager::getTime() - frameStart;
+      FrameStats::theOne().endFrame(frameTime - renderTime, renderTime, frameTime);
+      if (STRESS::ENABLED)
+        StressTest::theOne().record(frameTime - renderTime, frameTime);
     }
 
-    if (GAME::DISPLAY_FPS)
-      updateFPSCount(previousSecond, updates);
+    updateFPSCount();
 }
 
 bool Game::shouldRun() {
@@ -100,26 +172,35 @@ bool Game::shouldRun() {
 }
 
 bool Game::shouldUpdate() {
+  // the stress test and headless runs are uncapped so frame times reflect the real cost
+  if (STRESS::ENABLED || HEADLESS::ENABLED)
+    return true;
   currentTime = DisplayManager::getTime();
   delta += currentTime - lastTime;
   lastTime = currentTime;
   if (delta >= 1.0 / GAME::FPS) {
     delta -= 1.0/ GAME::FPS;
-    ++TIMER;
     return true;
   } else {
     return false;
   }
 }
 
-/* Helper function implementation */
+int Game::getFPS() const {
+  return fps;
+}
 
-void updateFPSCount(double& previousSecond, int& updates) {
+void Game::updateFPSCount() {
   if (DisplayManager::getTime() - previousSecond < 1.0) {
     return;
   }
 
   ++previousSecond;
-  cout << "FPS: " << updates << "\n";
+  fps = updates;
+  if (GAME::DISPLAY_FPS) {
+    const GLState::Stats& state = GLState::theOne().getFrameStats();
+    cout << "FPS: " << updates << ", GL state changes per frame: " << state.submitted << " submitted, "
+         << state.filtered << " filtered\n";
+  }
   updates = 0;
 }
@@ -1,13 +1,21 @@
 // Game.h
 #pragma once
+#include "World.h"
 #include <renderEngine/Renderer.h>
+#include <memory>
 
 class Game {
 private:
-  Renderer renderer;
+  // built by init, so the first frame does not pay for them
+  std::unique_ptr<World> world;
+  std::unique_ptr<Renderer> renderer;
 
   double currentTime, lastTime, previousSecond, delta;
   int updates = 0;
+  // updates counted over the last whole second
+  int fps = 0;
+
+  void updateFPSCount();
 public:
   Game();
   ~Game();
@@ -15,7 +23,19 @@ public:
   void run();
   bool shouldRun();
   bool shouldUpdate();
+  int getFPS() const;
 
-  static void init();
+  // generates the meshes on worker threads while the context is created and
+  // the shaders compile, then uploads them and builds the world; false if
+  // no display could be created
+  static bool init();
+  // releases the world, the renderer and everything holding GL objects, then
+  // the display. main calls it once the loop ends, see theOne
+  static void shutdown();
+  // a function-local static built in init before the renderer, so the
+  // singletons the renderer uses first (FontAtlas, FrameStats) are destroyed
+  // before it; only GpuResources is built ahead of it on purpose. Nothing
+  // may therefore be torn down in ~Game, shutdown() does that while all of
+  // them are still alive
   static Game& theOne();
 };
@@ -0,0 +1,150 @@
+// StressTest.cc
+#include "StressTest.h"
+#include <common.h>
+#include <maths/Maths.h>
+#include <entities/Entity.h>
+#include <entities/DynamicEntity.h>
+#include <entities/gameObjects/Sky.h>
+#include <entities/gameObjects/ObstacleHolder.h>
+#include <entities/gameObjects/BatteryHolder.h>
+#include <entities/gameObjects/ParticleHolder.h>
+#include <renderEngine/DisplayManager.h>
+#include <gameEngine/World.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+using std::cout;
+using std::vector;
+
+const char* REPORT_FILE = "../stress_report.csv";
+
+StressTest::StressTest():
+  stage(0),
+  frame(0),
+  finished(false),
+  tickTimeSum(0.0),
+  obstacleSum(0),
+  batterySum(0),
+  particleSum(0),
+  entitySum(0)
+{}
+
+StressTest::~StressTest() {}
+
+void StressTest::start() {
+  report.open(REPORT_FILE);
+  if (!report.is_open()) {
+    cout << "==================================================\n";
+    cout << "ERROR::STRESS: Failed to open file " << REPORT_FILE << "\n";
+    cout << "==================================================\n";
+  }
+  report << "stage,obstacle_multiplier,battery_multiplier,cloud_multiplier,particle_multiplier,"
+         << "obstacles,batteries,clouds,particles,entities,"
+         << "avg_tick_ms,avg_frame_ms,p95_frame_ms,max_frame_ms\n";
+  beginStage();
+}
+
+void StressTest::beginStage() {
+  frame = 0;
+  frameTimes.clear();
+  tickTimeSum = 0.0;
+  obstacleSum = batterySum = particleSum = entitySum = 0;
+  Sky::theOne().setCloudCount(scale(BASE_CLOUD_COUNT, STRESS_CLOUDS));
+  cout << "STRESS: stage " << stage + 1 << "/" << STRESS::STAGES
+       << ", obstacles x" << getMultiplier(STRESS_OBSTACLES)
+       << ", batteries x" << getMultiplier(STRESS_BATTERIES)
+       << ", clouds x" << getMultiplier(STRESS_CLOUDS)
+       << ", particles x" << getMultiplier(STRESS_PARTICLES) << "\n";
+}
+
+void StressTest::endStage() {
+  int samples = frameTimes.size();
+  double average = 0.0;
+  for (double time : frameTimes)
+    average += time;
+  average /= samples;
+  vector<double> sorted(frameTimes);
+  std::sort(sorted.begin(), sorted.end());
+  int p95 = std::max(0, (int)std::ceil(0.95 * samples) - 1);
+
+  report << stage + 1 << ","
+         << getMultiplier(STRESS_OBSTACLES) << ","
+         << getMultiplier(STRESS_BATTERIES) << ","
+         << getMultiplier(STRESS_CLOUDS) << ","
+         << getMultiplier(STRESS_PARTICLES) << ","
+         << obstacleSum / samples << ","
+         << batterySum / samples << ","
+         << Sky::theOne().getCloudCount() << ","
+         << particleSum / samples << ","
+         << entitySum / samples << ","
+         << 1000.0 * tickTimeSum / samples << ","
+         << 1000.0 * average << ","
+         << 1000.0 * sorted[p95] << ","
+         << 1000.0 * sorted.back() << "\n";
+  report.flush();
+  cout << "STRESS: stage " << stage + 1 << " avg frame " << 1000.0 * average
+       << " ms, p95 " << 1000.0 * sorted[p95] << " ms\n";
+}
+
+void StressTest::record(double tickTime, double frameTime) {
+  if (finished)
+    return;
+  // let the population settle before sampling
+  if (++frame <= STRESS::WARMUP_FRAMES)
+    return;
+
+  frameTimes.push_back(frameTime);
+  tickTimeSum += tickTime;
+  obstacleSum += ObstacleHolder::theOne().getCount();
+  batterySum += BatteryHolder::theOne().getCount();
+  particleSum += ParticleHolder::theOne().getCount();
+  entitySum += World::current().countEntities();
+
+  if ((int)frameTimes.size() < std::max(1, STRESS::SAMPLE_FRAMES))
+    return;
+  endStage();
+  if (++stage < STRESS::STAGES) {
+    beginStage();
+  } else {
+    finished = true;
+    report.close();
+    cout << "STRESS: report written to " << REPORT_FILE << "\n";
+    DisplayManager::closeDisplay();
+  }
+}
+
+bool StressTest::isFinished() const {
+  return finished;
+}
+
+float StressTest::getMultiplier(StressKind kind) const {
+  return multiplier(kind, stage);
+}
+
+float StressTest::multiplier(StressKind kind, int stage) {
+  if (!STRESS::ENABLED)
+    return 1.0f;
+  float base[] = {
+    STRESS::OBSTACLE_MULTIPLIER,
+    STRESS::BATTERY_MULTIPLIER,
+    STRESS::CLOUD_MULTIPLIER,
+    STRESS::PARTICLE_MULTIPLIER
+  };
+  return base[kind] * std::pow(STRESS::GROWTH, (float)stage);
+}
+
+int StressTest::scale(int count, StressKind kind) {
+  if (!STRESS::ENABLED)
+    return count;
+  // the fractional part becomes a spawn chance so small multipliers still average out
+  float scaled = count * theOne().getMultiplier(kind);
+  int result = (int)scaled;
+  if (Maths::chance(scaled - result))
+    ++result;
+  return result;
+}
+
+StressTest& StressTest::theOne() {
+  static StressTest stressTest;
+  return stressTest;
+}
@@ -0,0 +1,40 @@
+// StressTest.h
+#pragma once
+#include <fstream>
+#include <vector>
+
+enum StressKind {
+  STRESS_OBSTACLES = 0,
+  STRESS_BATTERIES,
+  STRESS_CLOUDS,
+  STRESS_PARTICLES
+};
+
+// steps the scene through STRESS::STAGES population levels and
+// writes per stage timings to a csv report
+class StressTest {
+private:
+  int stage;
+  int frame;
+  bool finished;
+  std::ofstream report;
+
+  std::vector<double> frameTimes;
+  double tickTimeSum;
+  long long obstacleSum, batterySum, particleSum, entitySum;
+
+  void beginStage();
+  void endStage();
+public:
+  StressTest();
+  ~StressTest();
+
+  void start();
+  void record(double tickTime, double frameTime);
+  bool isFinished() const;
+  float getMultiplier(StressKind kind) const;
+
+  static float multiplier(StressKind kind, int stage);
+  static int scale(int count, StressKind kind);
+  static StressTest& theOne();
+};
@@ -0,0 +1,100 @@
+// World.cc
+#include "World.h"
+#include "Collision.h"
+#include <common.h>
+#include <maths/Maths.h>
+#include <entities/gameObjects/ParticleHolder.h>
+#include <entities/gameObjects/ObstacleHolder.h>
+#include <entities/gameObjects/BatteryHolder.h>
+#include <entities/gameObjects/Sky.h>
+#include <entities/gameObjects/Airplane.h>
+#include <glm/glm.hpp>
+
+thread_local World* currentWorld = nullptr;
+
+// makes a world current for the lifetime of the scope
+class WorldScope {
+private:
+  World* previous;
+public:
+  WorldScope(World* world): previous(currentWorld) { World::makeCurrent(world); }
+  ~WorldScope() { World::makeCurrent(previous); }
+};
+
+World::World(unsigned int seed):
+  timer(0.0f),
+  airplaneDistance(0.0f),
+  miles(0.0f),
+  health(100.0f),
+  ambientLightIntensity(1.0f),
+  collisionSpeedX(0.0f),
+  collisionSpeedY(0.0f),
+  collisionDisplacementX(0.0f),
+  collisionDisplacementY(0.0f),
+  obstaclesHit(0),
+  batteriesCollected(0),
+  inputX(0.0f),
+  inputY(0.0f),
+  random(seed)
+{
+  // the game objects register their entities with the current world
+  WorldScope scope(this);
+  particleHolder.reset(new ParticleHolder());
+  obstacleHolder.reset(new ObstacleHolder());
+  batteryHolder.reset(new BatteryHolder());
+  sky.reset(new Sky());
+  airplane.reset(new Airplane());
+}
+
+World::~World() {
+  // destroyed entities unregister themselves and spawn debris in this world
+  WorldScope scope(this);
+  obstacleHolder.reset();
+  batteryHolder.reset();
+  sky.reset();
+  airplane.reset();
+  particleHolder.reset();
+}
+
+void World::beginTick() {
+  ++timer;
+  airplaneDistance += GAME::SPEED;
+  // arc length travelled over the sea surface
+  miles += GAME::SPEED * SEA::RADIUS;
+  ambientLightIntensity = glm::max(1.0f, ambientLightIntensity - 0.05f);
+  Collision::checkCollisionAgainstPlane();
+  particleHolder->update();
+}
+
+void World::endTick() {
+  obstacleHolder->update();
+  batteryHolder->update();
+  sky->update();
+  airplane->update();
+
+  health -= 0.025f;
+  health = Maths::clamp(-0.1f, health, 100.0f);
+}
+
+void World::tick() {
+  beginTick();
+  endTick();
+}
+
+int World::countEntities() const {
+  int total = 0;
+  for (auto& pair : staticEntities)
+    total += pair.second.size();
+  for (auto& pair : dynamicEntities)
+    total += pair.second.size();
+  return total;
+}
+
+World& World::current() {
+  return *currentWorld;
+}
+
+void World::makeCurrent(World* world) {
+  currentWorld = world;
+  Maths::setGenerator(world ? &world->random : nullptr);
+}
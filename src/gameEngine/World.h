@@ -0,0 +1,51 @@
+// World.h
+#pragma once
+#include <entities/Entity.h>
+#include <entities/DynamicEntity.h>
+#include <memory>
+#include <random>
+
+class ParticleHolder;
+class ObstacleHolder;
+class BatteryHolder;
+class Sky;
+class Airplane;
+
+// all state of one game session, so independent sessions can tick on
+// different threads; each thread works on whichever world is current
+class World {
+public:
+  float timer;
+  float airplaneDistance;
+  float miles;
+  float health;
+  float ambientLightIntensity;
+  float collisionSpeedX, collisionSpeedY;
+  float collisionDisplacementX, collisionDisplacementY;
+  int obstaclesHit;
+  int batteriesCollected;
+  // normalized steering in [-1, 1], from the mouse or an autopilot
+  float inputX, inputY;
+  std::mt19937 random;
+
+  StaticEntities staticEntities;
+  DynamicEntities dynamicEntities;
+  std::unique_ptr<ParticleHolder> particleHolder;
+  std::unique_ptr<ObstacleHolder> obstacleHolder;
+  std::unique_ptr<BatteryHolder> batteryHolder;
+  std::unique_ptr<Sky> sky;
+  std::unique_ptr<Airplane> airplane;
+
+  World(unsigned int seed = std::mt19937::default_seed);
+  ~World();
+
+  // the game renders between the two halves of a tick
+  void beginTick();
+  void endTick();
+  void tick();
+  // static and dynamic entities in the scene
+  int countEntities() const;
+
+  static World& current();
+  static void makeCurrent(World* world);
+};
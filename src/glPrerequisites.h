@@ -1,2 +1,7 @@
 #pragma once
 #include <glad/glad.h>
+
+// GL_KHR_parallel_shader_compile, not in every glad build
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
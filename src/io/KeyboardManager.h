@@ -60,6 +60,7 @@ enum KEYS {
   KEY_LEFT = 263,
   KEY_DOWN = 264,
   KEY_UP = 265,
+  KEY_F3 = 292,
 
   KEY_TAB = 258,
   KEY_LSB = 91,
@@ -8,8 +8,6 @@ using std::cout;
 using std::ifstream;
 using std::string;
 
-float AMBIENT_LIGHT_INTENSITY = 1.0f;
-
 float GAME::SPEED;
 float GAME::FPS;
 int GAME::DISPLAY_FPS;
@@ -33,10 +31,18 @@ float LIGHT::X;
 float LIGHT::Y;
 float LIGHT::Z;
 
-float SHADOW::NEAR_PLANE;
-float SHADOW::FAR_PLANE;
+float SHADOW::DISTANCE;
+float SHADOW::DEPTH;
 int SHADOW::WIDTH;
 int SHADOW::HEIGHT;
+int SHADOW::DEPTH_BITS = 16;
+int SHADOW::STATIC_INTERVAL = 1;
+int SHADOW::DYNAMIC_INTERVAL = 1;
+int SHADOW::KERNEL_TAPS = 4;
+
+float FOG::START = 100.0f;
+float FOG::END = 500.0f;
+float FOG::SEA_END = 300.0f;
 
 float AIRPLANE::X;
 float AIRPLANE::Y;
@@ -46,6 +52,39 @@ float AIRPLANE::ROTATE_SENSITITY;
 float AIRPLANE::AMPWIDTH;
 float AIRPLANE::AMPHEIGHT;
 
+int STRESS::ENABLED = 0;
+int STRESS::STAGES = 1;
+float STRESS::GROWTH = 1.0f;
+int STRESS::WARMUP_FRAMES = 0;
+int STRESS::SAMPLE_FRAMES = 0;
+float STRESS::OBSTACLE_MULTIPLIER = 1.0f;
+float STRESS::BATTERY_MULTIPLIER = 1.0f;
+float STRESS::CLOUD_MULTIPLIER = 1.0f;
+float STRESS::PARTICLE_MULTIPLIER = 1.0f;
+
+int HEADLESS::ENABLED = 0;
+int HEADLESS::WIDTH = 1280;
+int HEADLESS::HEIGHT = 720;
+int HEADLESS::FRAMES = 300;
+int HEADLESS::TOLERANCE = 8;
+float HEADLESS::MAX_MISMATCH_PERCENT = 0.5f;
+const char* HEADLESS::GOLDEN = nullptr;
+const char* HEADLESS::OUTPUT = "../headless.ppm";
+
+const char* CAPTURE::OUTPUT = nullptr;
+int CAPTURE::PNG = 0;
+int CAPTURE::INTERVAL = 1;
+
+const char* STATS::OUTPUT = nullptr;
+int STATS::OVERLAY = 0;
+
+int MEMORY::BUDGET = 0;
+
+int BATCH::SESSIONS = 0;
+int BATCH::THREADS = 0;
+int BATCH::TICKS = 3600;
+int BATCH::SEED = 1;
+
 // helper
 void getNextFloat(ifstream& file, float* value) {
   string word;
@@ -99,10 +138,18 @@ void Parser::parse() {
   getNextFloat(configFile, &LIGHT::Y);
   getNextFloat(configFile, &LIGHT::Z);
 
-  getNextFloat(configFile, &SHADOW::NEAR_PLANE);
-  getNextFloat(configFile, &SHADOW::FAR_PLANE);
+  getNextFloat(configFile, &SHADOW::DISTANCE);
+  getNextFloat(configFile, &SHADOW::DEPTH);
   getNextInt(configFile, &SHADOW::WIDTH);
   getNextInt(configFile, &SHADOW::HEIGHT);
+  getNextInt(configFile, &SHADOW::DEPTH_BITS);
+  getNextInt(configFile, &SHADOW::STATIC_INTERVAL);
+  getNextInt(configFile, &SHADOW::DYNAMIC_INTERVAL);
+  getNextInt(configFile, &SHADOW::KERNEL_TAPS);
+
+  getNextFloat(configFile, &FOG::START);
+  getNextFloat(configFile, &FOG::END);
+  getNextFloat(configFile, &FOG::SEA_END);
 
   getNextFloat(configFile, &AIRPLANE::X);
   getNextFloat(configFile, &AIRPLANE::Y);
@@ -112,3 +159,78 @@ void Parser::parse() {
   getNextFloat(configFile, &AIRPLANE::AMPWIDTH);
   getNextFloat(configFile, &AIRPLANE::AMPHEIGHT);
 }
+
+void Parser::parseArguments(int argc, char** argv) {
+  for (int i = 1; i < argc; ++i) {
+    string arg(argv[i]);
+    if (arg == "--stress" && i + 1 < argc) {
+      parseStressScene(argv[++i]);
+    } else if (arg == "--batch" && i + 1 < argc) {
+      BATCH::SESSIONS = std::stoi(argv[++i]);
+    } else if (arg == "--threads" && i + 1 < argc) {
+      BATCH::THREADS = std::stoi(argv[++i]);
+    } else if (arg == "--ticks" && i + 1 < argc) {
+      BATCH::TICKS = std::stoi(argv[++i]);
+    } else if (arg == "--seed" && i + 1 < argc) {
+      BATCH::SEED = std::stoi(argv[++i]);
+    } else if (arg == "--capture" && i + 1 < argc) {
+      CAPTURE::OUTPUT = argv[++i];
+    } else if (arg == "--capture-png" && i + 1 < argc) {
+      CAPTURE::OUTPUT = argv[++i];
+      CAPTURE::PNG = 1;
+    } else if (arg == "--capture-interval" && i + 1 < argc) {
+      CAPTURE::INTERVAL = std::stoi(argv[++i]);
+    } else if (arg == "--stats" && i + 1 < argc) {
+      STATS::OUTPUT = argv[++i];
+    } else if (arg == "--overlay") {
+      STATS::OVERLAY = 1;
+    } else if (arg == "--memory-budget" && i + 1 < argc) {
+      MEMORY::BUDGET = std::stoi(argv[++i]);
+    } else if (arg == "--headless") {
+      HEADLESS::ENABLED = 1;
+    } else if (arg == "--size" && i + 2 < argc) {
+      HEADLESS::WIDTH = std::stoi(argv[++i]);
+      HEADLESS::HEIGHT = std::stoi(argv[++i]);
+    } else if (arg == "--frames" && i + 1 < argc) {
+      HEADLESS::FRAMES = std::stoi(argv[++i]);
+    } else if (arg == "--output" && i + 1 < argc) {
+      HEADLESS::OUTPUT = argv[++i];
+    } else if (arg == "--golden" && i + 1 < argc) {
+      HEADLESS::GOLDEN = argv[++i];
+    } else if (arg == "--tolerance" && i + 1 < argc) {
+      HEADLESS::TOLERANCE = std::stoi(argv[++i]);
+    } else if (arg == "--max-mismatch" && i + 1 < argc) {
+      HEADLESS::MAX_MISMATCH_PERCENT = std::stof(argv[++i]);
+    } else {
+      std::cout << "==================================================\n";
+      std::cout << "ERROR::PARSER: Unknown argument " << arg << "\n";
+      std::cout << "Usage: TheAviator [--stress <scene file>] [--capture <rgb file> | --capture-png <prefix>] [--capture-interval <n>]\n";
+      std::cout << "                  [--stats <csv or json file>] [--overlay] [--memory-budget <MB>]\n";
+      std::cout << "       TheAviator --batch <sessions> [--threads <n>] [--ticks <n>] [--seed <n>]\n";
+      std::cout << "       TheAviator --headless [--size <width> <height>] [--frames <n>] [--output <ppm>]\n";
+      std::cout << "                  [--golden <ppm>] [--tolerance <n>] [--max-mismatch <percent>]";
+      std::cout << "\n==================================================\n";
+    }
+  }
+}
+
+void Parser::parseStressScene(const char* fileName) {
+  ifstream sceneFile;
+  sceneFile.open(fileName);
+  if (!sceneFile.is_open()) {
+    std::cout << "==================================================\n";
+    std::cout << "ERROR::PARSER: Failed to open file " << fileName << "\n";
+    std::cout << "\n==================================================\n";
+    return;
+  }
+  STRESS::ENABLED = 1;
+  getNextInt(sceneFile, &STRESS::STAGES);
+  getNextFloat(sceneFile, &STRESS::GROWTH);
+  getNextInt(sceneFile, &STRESS::WARMUP_FRAMES);
+  getNextInt(sceneFile, &STRESS::SAMPLE_FRAMES);
+
+  getNextFloat(sceneFile, &STRESS::OBSTACLE_MULTIPLIER);
+  getNextFloat(sceneFile, &STRESS::BATTERY_MULTIPLIER);
+  getNextFloat(sceneFile, &STRESS::CLOUD_MULTIPLIER);
+  getNextFloat(sceneFile, &STRESS::PARTICLE_MULTIPLIER);
+}
@@ -2,4 +2,6 @@
 
 namespace Parser {
   void parse();
+  void parseArguments(int argc, char** argv);
+  void parseStressScene(const char* fileName);
 };
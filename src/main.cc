@@ -1,10 +1,23 @@
 // main.cc
 #include <gameEngine/Game.h>
+#include <gameEngine/BatchRunner.h>
+#include <common.h>
+#include <io/Parser.h>
+#include <renderEngine/DisplayManager.h>
 
-int main() {
-  Game::init();
+int main(int argc, char** argv) {
+  Parser::parse();
+  Parser::parseArguments(argc, argv);
+  if (BATCH::SESSIONS > 0) {
+    BatchRunner::run();
+    return 0;
+  }
+
+  if (!Game::init())
+    return 1;
   while (Game::theOne().shouldRun()) {
     Game::theOne().run();
   }
-  return 0;
+  Game::shutdown();
+  return DisplayManager::getExitCode();
 }
@@ -3,16 +3,32 @@
 #include <utils/Debug.h>
 #include <glm/gtc/matrix_transform.hpp>
 #include <algorithm>
-#include <cstdlib>
+#include <cassert>
 #include <iostream>
 using std::cout;
 
+thread_local std::mt19937 defaultGenerator;
+thread_local std::mt19937* generator = &defaultGenerator;
+
+float random01() {
+  // the distribution may round up to 1, keep the range half open for Maths::rand(int, int)
+  float value = std::uniform_real_distribution<float>(0.0f, 1.0f)(*generator);
+  return value < 1.0f ? value : 0.0f;
+}
+
+// max is exclusive. random01() stays below 1, but the product may still round
+// up to max - min for wide ranges, so the result is checked as well
 int Maths::rand(int min, int max) {
-  return min + std::rand() * (float)(max - min) / (float)RAND_MAX;
+  if (max <= min)
+    return min;
+  int value = min + (int)(random01() * (float)(max - min));
+  value = std::min(value, max - 1);
+  assert(value >= min && value < max);
+  return value;
 }
 
 float Maths::rand(float min, float max) {
-  return min + (float)std::rand() / (float)RAND_MAX * (max - min);
+  return min + random01() * (max - min);
 }
 
 float Maths::clamp(float low, float value, float high) {
@@ -28,6 +44,10 @@ bool Maths::chance(float chance) {
   return chance >= rand(0.0f, 1.0f);
 }
 
+void Maths::setGenerator(std::mt19937* generator) {
+  ::generator = generator ? generator : &defaultGenerator;
+}
+
 glm::mat4 Maths::calculateTranslationMatrix(float x, float y, float z) {
   glm::vec3 delta = glm::vec3(x, y, z);
   glm::mat4 translation(1.0f);
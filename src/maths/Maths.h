@@ -1,14 +1,18 @@
 // Maths.h
 #pragma once
 #include <glm/glm.hpp>
+#include <random>
 #define PI 3.14159265358979323846
 
 namespace Maths {
+  // min inclusive, max exclusive
   int rand(int min, int max);
   float rand(float min, float max);
   float clamp(float low, float value, float high);
   float clamp(float value, float low, float high, float clampLow, float clampHigh);
   bool chance(float chance);
+  // random numbers on this thread come from generator, nullptr restores the default
+  void setGenerator(std::mt19937* generator);
 
   glm::mat4 calculateTranslationMatrix(float x, float y, float z);
   glm::mat4 calculateRotationMatrix(float x, float y, float z, glm::vec3 center);
@@ -1,8 +1,21 @@
 // Object3D.cc
 #include "Object3D.h"
+#include <utils/MemoryTracker.h>
 
 Object3D::Object3D(): type(UNKNOWN), center(glm::vec3(0.0f)) {}
 
+Object3D::~Object3D() {}
+
+void* Object3D::operator new(std::size_t size) {
+  MemoryTracker::theOne().allocate(MEMORY_COLLIDERS, size);
+  return ::operator new(size);
+}
+
+void Object3D::operator delete(void* pointer, std::size_t size) {
+  MemoryTracker::theOne().release(MEMORY_COLLIDERS, size);
+  ::operator delete(pointer);
+}
+
 Sphere::Sphere(float radius): radius(radius) {
   type = SPHERE;
 }
\ No newline at end of file
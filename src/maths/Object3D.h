@@ -1,6 +1,7 @@
 // Object3D.h
 #pragma once
 #include <glm/glm.hpp>
+#include <cstddef>
 
 enum Type {
   UNKNOWN = 0,
@@ -15,6 +16,12 @@ public:
   glm::vec3 center;
 
   Object3D();
+  // entities delete their body through this class
+  virtual ~Object3D();
+
+  // counted under MEMORY_COLLIDERS
+  static void* operator new(std::size_t size);
+  static void operator delete(void* pointer, std::size_t size);
 };
 
 class Sphere: public Object3D {
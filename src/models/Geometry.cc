@@ -1,10 +1,20 @@
 // Geometry.cc
 #include "Geometry.h"
 #include "Loader.h"
+#include "MeshBuilder.h"
 #include <common.h>
 #include <maths/Maths.h>
 #include <utils/Debug.h>
+#include <utils/MemoryTracker.h>
+#include <glm/gtc/matrix_transform.hpp>
 #include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <thread>
 #include <vector>
 #include <iostream>
 #include <cassert>
@@ -18,25 +28,163 @@ RawModel* Geometry::cockpit;
 RawModel* Geometry::propeller;
 RawModel* Geometry::tetrahedron;
 RawModel* Geometry::quad;
+RawModel* Geometry::particle;
+RawModel* Geometry::airplane;
+RawModel* Geometry::clouds[CLOUD_VARIANTS];
+
+MeshData Geometry::cubeMesh;
+MeshData Geometry::cockpitMesh;
+
+// cpu side of a model, generated on a worker thread and uploaded later by
+// the thread owning the context
+struct PendingModel {
+  MeshData mesh;
+  // indexed models keep their per vertex data and indices here
+  vector<float> data;
+  vector<unsigned int> indices;
+  // flat models only have positions of this dimension
+  int dimension;
+  vector<LodLevel> lods;
+};
+
+struct GeometryJob {
+  std::function<PendingModel()> build;
+  // every model uploaded from the result
+  vector<RawModel**> targets;
+  PendingModel result;
+  double milliseconds;
+};
+
+static vector<GeometryJob> jobs;
+static vector<std::thread> workers;
+static double generationTime = 0.0;
+static int generationThreads = 0;
+
+PendingModel pendingMesh(const MeshData& mesh);
+MeshData createTetrahedronMesh(int segments);
+PendingModel createSphere();
+MeshData createCube();
+// the sea always fills most of the screen, only the shadow bias reaches its coarser levels
+const int SEA_LODS = 3;
+const int SEA_MIN_RADIAL_SEGMENTS = 8;
+const float SEA_LOD_SCREEN_SIZE[SEA_LODS] = { 0.25f, 0.05f, 0.0f };
+
+PendingModel createSea(float radius, float height, int radialSegments, int heightSegments);
+MeshData createCockpit();
+MeshData createPropeller();
+PendingModel createQuad();
+MeshData createAirplane();
+MeshData createCloud();
+
+static void addJob(std::function<PendingModel()> build, RawModel** target, RawModel** second = nullptr) {
+  GeometryJob job;
+  job.build = build;
+  job.targets.push_back(target);
+  if (second)
+    job.targets.push_back(second);
+  job.milliseconds = 0.0;
+  jobs.push_back(job);
+}
+
+static RawModel* uploadModel(PendingModel& pending) {
+  RawModel* model;
+  if (pending.dimension)
+    model = Loader::loadToVAO(pending.mesh.positions, pending.dimension);
+  else if (!pending.indices.empty())
+    model = Loader::loadIndexedToVAO(pending.mesh.positions, pending.data, pending.indices);
+  else
+    model = Loader::loadMeshToVAO(pending.mesh.positions, pending.mesh.normals, pending.mesh.colors);
+  if (!pending.lods.empty())
+    model->setLods(pending.lods);
+  return model;
+}
+
+static long long meshBytes(const MeshData& mesh) {
+  return (mesh.positions.size() + mesh.normals.size() + mesh.colors.size()) * sizeof(float);
+}
+
+static long long pendingBytes(const PendingModel& pending) {
+  return meshBytes(pending.mesh) + pending.data.size() * sizeof(float) +
+         pending.indices.size() * sizeof(unsigned int) + pending.lods.size() * sizeof(LodLevel);
+}
+
+void Geometry::generateGeometry() {
+  // the baked models are made of these two, so they are built up front
+  cubeMesh = createCube();
+  cockpitMesh = createCockpit();
+  MemoryTracker::theOne().allocate(MEMORY_MESHES, meshBytes(cubeMesh));
+  MemoryTracker::theOne().allocate(MEMORY_MESHES, meshBytes(cockpitMesh));
+
+  jobs.clear();
+  addJob([]() { return pendingMesh(cubeMesh); }, &cube);
+  addJob([]() { return pendingMesh(cockpitMesh); }, &cockpit);
+  addJob([]() { return pendingMesh(createTetrahedronMesh(1)); }, &tetrahedron, &particle);
+  addJob([]() { return createSphere(); }, &sphere);
+  addJob([]() { return createSea(SEA::RADIUS, SEA::HEIGHT, SEA::RADIAL_SEGMENTS, SEA::HEIGHT_SEGMENTS); }, &sea);
+  addJob([]() { return pendingMesh(createPropeller()); }, &propeller);
+  addJob([]() { return createQuad(); }, &quad);
+  addJob([]() { return pendingMesh(createAirplane()); }, &airplane);
+  for (int i = 0; i < CLOUD_VARIANTS; ++i) {
+    addJob([]() { return pendingMesh(createCloud()); }, &clouds[i]);
+  }
 
-RawModel* createTetrahedron(int segments = 1);
-RawModel* createCube();
-RawModel* createSea(float radius, float height, int radialSegments, int heightSegments);
-RawModel* createCockpit();
-RawModel* createPropeller();
-RawModel* createQuad();
+  // one core is left to the main thread, which creates the context and
+  // compiles the shaders meanwhile
+  static std::atomic<int> next;
+  next = 0;
+  int threads = std::max(1, std::min((int)std::thread::hardware_concurrency() - 1, (int)jobs.size()));
+  generationThreads = threads;
+  for (int i = 0; i < threads; ++i) {
+    workers.push_back(std::thread([]() {
+      for (int index = next++; index < (int)jobs.size(); index = next++) {
+        GeometryJob& job = jobs[index];
+        // every job draws from its own generator, so the meshes do not depend on scheduling
+        std::mt19937 random(index + 1);
+        Maths::setGenerator(&random);
+        auto start = std::chrono::steady_clock::now();
+        job.result = job.build();
+        MemoryTracker::theOne().allocate(MEMORY_MESHES, pendingBytes(job.result));
+        job.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Maths::setGenerator(nullptr);
+      }
+    }));
+  }
+}
+
+void Geometry::waitGeometry() {
+  for (std::thread& worker : workers)
+    worker.join();
+  workers.clear();
+}
+
+void Geometry::uploadGeometry() {
+  waitGeometry();
+  generationTime = 0.0;
+  for (GeometryJob& job : jobs) {
+    for (RawModel** target : job.targets)
+      *target = uploadModel(job.result);
+    generationTime += job.milliseconds;
+    MemoryTracker::theOne().release(MEMORY_MESHES, pendingBytes(job.result));
+  }
+  jobs.clear();
+}
 
 void Geometry::initGeometry() {
-  tetrahedron = createTetrahedron();
-  cube = createCube();
-  sphere = createTetrahedron(4);
-  sea = createSea(SEA::RADIUS, SEA::HEIGHT, SEA::RADIAL_SEGMENTS, SEA::HEIGHT_SEGMENTS);
-  cockpit = createCockpit();
-  propeller = createPropeller();
-  quad = createQuad();
+  generateGeometry();
+  uploadGeometry();
+}
+
+double Geometry::getGenerationTime() {
+  return generationTime;
+}
+
+int Geometry::getGenerationThreads() {
+  return generationThreads;
 }
 
 void Geometry::cleanGeometry() {
+  MemoryTracker::theOne().release(MEMORY_MESHES, meshBytes(cubeMesh));
+  MemoryTracker::theOne().release(MEMORY_MESHES, meshBytes(cockpitMesh));
   delete tetrahedron;
   delete cube;
   delete sphere;
@@ -44,6 +192,11 @@ void Geometry::cleanGeometry() {
   delete cockpit;
   delete propeller;
   delete quad;
+  delete particle;
+  delete airplane;
+  for (int i = 0; i < CLOUD_VARIANTS; ++i) {
+    delete clouds[i];
+  }
 }
 
 /* helper functions for createTetrahedron */
@@ -86,7 +239,36 @@ void tetrahedronHelper(int segments, glm::vec3 vert1, glm::vec3 vert2, glm::vec3
   }
 }
 
-RawModel* createTetrahedron(int segments) {
+PendingModel pendingMesh(const MeshData& mesh) {
+  PendingModel pending;
+  pending.mesh = mesh;
+  pending.dimension = 0;
+  return pending;
+}
+
+// subdivision and smallest screen size of each sphere level, finest first
+const int SPHERE_LOD_SEGMENTS[] = { 4, 2, 1 };
+const float SPHERE_LOD_SCREEN_SIZE[] = { 0.08f, 0.02f, 0.0f };
+
+// all levels share one vertex buffer, so switching level needs no rebind
+PendingModel createSphere() {
+  MeshData chain;
+  vector<LodLevel> lods;
+  for (size_t i = 0; i < std::size(SPHERE_LOD_SEGMENTS); ++i) {
+    MeshData level = createTetrahedronMesh(SPHERE_LOD_SEGMENTS[i]);
+    unsigned int first = chain.positions.size() / 3;
+    unsigned int count = level.positions.size() / 3;
+    lods.push_back({ first, count, SPHERE_LOD_SCREEN_SIZE[i] });
+    chain.positions.insert(chain.positions.end(), level.positions.begin(), level.positions.end());
+    chain.normals.insert(chain.normals.end(), level.normals.begin(), level.normals.end());
+  }
+
+  PendingModel model = pendingMesh(chain);
+  model.lods = lods;
+  return model;
+}
+
+MeshData createTetrahedronMesh(int segments) {
   assert(segments > 0);
   vector<glm::vec3> vertices;
   if (segments == 1) {
@@ -131,10 +313,11 @@ RawModel* createTetrahedron(int segments) {
     }
   }
 
-  return Loader::loadToVAO(vertexArray, 3, normals, 3);
+  MeshData mesh = { vertexArray, normals, {} };
+  return mesh;
 }
 
-RawModel* createQuad() {
+PendingModel createQuad() {
   vector<float> vertices;
   vertices.push_back(-0.5f);
   vertices.push_back(0.5f);
@@ -149,10 +332,13 @@ RawModel* createQuad() {
   vertices.push_back(-0.5f);
   vertices.push_back(-0.5f);
   vertices.push_back(0.5f);
-  return Loader::loadToVAO(vertices, 2);
+  PendingModel model = pendingMesh(MeshData());
+  model.mesh.positions = vertices;
+  model.dimension = 2;
+  return model;
 }
 
-RawModel* createCube() {
+MeshData createCube() {
   glm::vec3 vert0(0.5f, 0.5f, 0.5f);
   glm::vec3 vert1(0.5f, 0.5f, -0.5f);
   glm::vec3 vert2(0.5f, -0.5f, 0.5f);
@@ -225,10 +411,11 @@ RawModel* createCube() {
     }
   }
 
-  return Loader::loadToVAO(vertexArray, 3, normals, 3);
+  MeshData mesh = { vertexArray, normals, {} };
+  return mesh;
 }
 
-RawModel* createSea(float radius, float height, int radialSegments, int heightSegments) {
+PendingModel createSea(float radius, float height, int radialSegments, int heightSegments) {
   assert(radialSegments > 0);
   assert(heightSegments > 0);
   float angleIncrement = 360 / radialSegments;
@@ -258,33 +445,49 @@ RawModel* createSea(float radius, float height, int radialSegments, int heightSe
   waves.push_back(Maths::rand(SEA::MIN_SPEED, SEA::MAX_SPEED));
 
 
-  int index1 = radialSegments - 1;
-  for (int i = 0; i < heightSegments; ++i) {
-    for (int index2 = 0; index2 < radialSegments; index1 = index2++) {
-      int point1 = index1 + i * radialSegments, point2 = index2 + i * radialSegments, point3 = point1 + radialSegments, point4 = point2 + radialSegments;
-      // triangle 1
-      indices.push_back(point2);
-      indices.push_back(point1);
-      indices.push_back(point3);
-      // triangle 2
-      indices.push_back(point2);
-      indices.push_back(point3);
-      indices.push_back(point4);
+  // coarser levels skip ring columns of the same vertex grid, so every level
+  // shares the wave attributes and moves identically
+  int topPoint = vertices.size() / 3 - 1;
+  vector<LodLevel> lods;
+  for (int stride = 1, level = 0; level < SEA_LODS; stride *= 2, ++level) {
+    if (radialSegments % stride || radialSegments / stride < SEA_MIN_RADIAL_SEGMENTS)
+      break;
+    unsigned int first = indices.size();
+
+    int index1 = radialSegments - stride;
+    for (int i = 0; i < heightSegments; ++i) {
+      for (int index2 = 0; index2 < radialSegments; index1 = index2, index2 += stride) {
+        int point1 = index1 + i * radialSegments, point2 = index2 + i * radialSegments, point3 = point1 + radialSegments, point4 = point2 + radialSegments;
+        // triangle 1
+        indices.push_back(point2);
+        indices.push_back(point1);
+        indices.push_back(point3);
+        // triangle 2
+        indices.push_back(point2);
+        indices.push_back(point3);
+        indices.push_back(point4);
+      }
+    }
+
+    index1 = radialSegments - stride;
+    for (int i = 0; i < radialSegments - stride; index1 = i, i += stride) {
+      indices.push_back(topPoint);
+      indices.push_back(i);
+      indices.push_back(index1);
     }
-  }
 
-  int topPoint = vertices.size() - 1;
-  index1 = radialSegments - 1;
-  for (int i = 0; i < radialSegments - 1; index1 = i++) {
-    indices.push_back(topPoint);
-    indices.push_back(i);
-    indices.push_back(index1);
+    lods.push_back({ first, (unsigned int)indices.size() - first, SEA_LOD_SCREEN_SIZE[level] });
   }
 
-  return Loader::loadToVAO(vertices, 3, waves, 3, indices);
+  PendingModel model = pendingMesh(MeshData());
+  model.mesh.positions = vertices;
+  model.data = waves;
+  model.indices = indices;
+  model.lods = lods;
+  return model;
 }
 
-RawModel* createCockpit() {
+MeshData createCockpit() {
   glm::vec3 vert0(4, 2.5, 2.5);
   glm::vec3 vert1(4, 2.5, -2.5);
   glm::vec3 vert2(4, -2.5, 2.5);
@@ -357,10 +560,11 @@ RawModel* createCockpit() {
     }
   }
 
-  return Loader::loadToVAO(vertexArray, 3, normals, 3);
+  MeshData mesh = { vertexArray, normals, {} };
+  return mesh;
 }
 
-RawModel* createPropeller() {
+MeshData createPropeller() {
   glm::vec3 vert0(0.5, 0.5, 0.5);
   glm::vec3 vert1(0.5, 0.5, -0.5);
   glm::vec3 vert2(0.5, -0.5, 0.5);
@@ -433,5 +637,58 @@ RawModel* createPropeller() {
     }
   }
 
-  return Loader::loadToVAO(vertexArray, 3, normals, 3);
+  MeshData mesh = { vertexArray, normals, {} };
+  return mesh;
+}
+
+/* helper functions for baked models */
+glm::mat4 partTransform(glm::vec3 position, glm::vec3 scale) {
+  return glm::scale(glm::translate(glm::mat4(1.0f), position), scale);
+}
+
+MeshData createAirplane() {
+  glm::vec3 red(RED[0], RED[1], RED[2]);
+  glm::vec3 white(WHITE[0], WHITE[1], WHITE[2]);
+  glm::vec3 brown(BROWN[0], BROWN[1], BROWN[2]);
+  glm::vec3 brownDark(BROWNDARK[0], BROWNDARK[1], BROWNDARK[2]);
+  glm::vec3 pink(PINK[0], PINK[1], PINK[2]);
+  glm::vec3 axisZ(0.0f, 0.0f, 1.0f);
+
+  MeshBuilder builder;
+  // plane
+  builder.add(Geometry::cockpitMesh, partTransform(glm::vec3(0.0f), glm::vec3(1.0f)), red);
+  builder.add(Geometry::cubeMesh, partTransform(glm::vec3(5.0f, 0.0f, 0.0f), glm::vec3(2.0f, 5.0f, 5.0f)), white);
+  builder.add(Geometry::cubeMesh, partTransform(glm::vec3(-4.0f, 2.0f, 0.0f), glm::vec3(1.5f, 2.0f, 0.5f)), red);
+  builder.add(Geometry::cubeMesh, partTransform(glm::vec3(0.0f, 1.5f, 0.0f), glm::vec3(3.0f, 0.5f, 12.0f)), red);
+  builder.add(Geometry::cubeMesh, partTransform(glm::vec3(2.5f, -2.0f, 2.5f), glm::vec3(3.0f, 1.5f, 1.0f)), red);
+  builder.add(Geometry::cubeMesh, partTransform(glm::vec3(2.5f, -2.0f, -2.5f), glm::vec3(3.0f, 1.5f, 1.0f)), red);
+  builder.add(Geometry::cubeMesh, partTransform(glm::vec3(2.5f, -2.8f, 2.5f), glm::vec3(2.4f, 2.4f, 0.4f)), brownDark);
+  builder.add(Geometry::cubeMesh, partTransform(glm::vec3(2.5f, -2.8f, -2.5f), glm::vec3(2.4f, 2.4f, 0.4f)), brownDark);
+  builder.add(Geometry::cubeMesh, partTransform(glm::vec3(2.5, -2.8f, 0.0f), glm::vec3(1.0f, 1.0f, 6.0f)), brown);
+  glm::vec3 suspension(-3.2f, 0.5f, 0.0f);
+  builder.add(Geometry::cubeMesh, Maths::rotateAroundAxis(axisZ, -0.3f, suspension) * partTransform(suspension, glm::vec3(0.4f, 2.0f, 0.4f)), red);
+  builder.add(Geometry::cubeMesh, partTransform(glm::vec3(-3.5f, -0.5f, 0.0f), glm::vec3(1.2f, 1.2f, 0.2f)), brownDark);
+  builder.add(Geometry::cubeMesh, partTransform(glm::vec3(-3.5f, -0.5f, 0.0f), glm::vec3(0.5f, 0.5f, 0.3f)), brown);
+  // pilot
+  builder.add(Geometry::cubeMesh, partTransform(glm::vec3(-0.8f, 1.5f, 0.0f), glm::vec3(1.5f)), brown);
+  builder.add(Geometry::cubeMesh, partTransform(glm::vec3(-1.0f, 2.7f, 0.0f), glm::vec3(1.0f)), pink);
+  builder.add(Geometry::cubeMesh, partTransform(glm::vec3(-1.3f, 3.0f, 0.0f), glm::vec3(1.2f, 0.4f, 1.2f)), brown);
+  builder.add(Geometry::cubeMesh, partTransform(glm::vec3(-1.6f, 2.8f, 0.0f), glm::vec3(0.2f, 0.8f, 1.0f)), brown);
+  // transparent parts go last so they blend over the rest of the plane
+  builder.add(Geometry::cubeMesh, partTransform(glm::vec3(0.5f, 2.7f, 0.0f), glm::vec3(0.3f, 1.5f, 2.0f)), white, 0.3f);
+  return builder.getMesh();
+}
+
+MeshData createCloud() {
+  MeshBuilder builder;
+  int nBlocks = 3 + Maths::rand(0, 3);
+  // centered, so the whole cloud spins around its middle
+  float offset = (float)(nBlocks - 1) * 2.5f;
+  for (int i = 0; i < nBlocks; ++i) {
+    glm::vec3 position((float)i * 5.0f - offset, Maths::rand(0.0f, 4.0f), Maths::rand(0.0f, 4.0f));
+    float scale = 8.0f * Maths::rand(0.5f, 0.9f);
+    glm::mat4 rotation = Maths::calculateRotationMatrix(0.0f, Maths::rand(0.0f, 2 * PI), Maths::rand(0.0f, 2.0f * PI), position);
+    builder.add(Geometry::cubeMesh, rotation * partTransform(position, glm::vec3(scale)), glm::vec3(1.0f));
+  }
+  return builder.getMesh();
 }
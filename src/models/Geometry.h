@@ -3,6 +3,17 @@
 #include "RawModel.h"
 #include <glm/glm.hpp>
 #include <string>
+#include <vector>
+
+// cpu copy of a mesh, kept around to bake merged models
+struct MeshData {
+  std::vector<float> positions;
+  std::vector<float> normals;
+  // rgba per vertex, empty unless the mesh is baked
+  std::vector<float> colors;
+};
+
+const int CLOUD_VARIANTS = 8;
 
 namespace Geometry {
   // models
@@ -13,7 +24,23 @@ namespace Geometry {
   extern RawModel* cockpit;
   extern RawModel* propeller;
   extern RawModel* quad;
+  // same mesh as tetrahedron, owns the per-instance particle attributes
+  extern RawModel* particle;
+  // rigid parts of the plane and the pilot baked into one vertex colored mesh
+  extern RawModel* airplane;
+  extern RawModel* clouds[CLOUD_VARIANTS];
+
+  extern MeshData cubeMesh;
+  extern MeshData cockpitMesh;
 
+  // builds the cpu side of every model on worker threads and returns at once
+  void generateGeometry();
+  void waitGeometry();
+  // waits for the workers and uploads the models, on the thread owning the context
+  void uploadGeometry();
   void initGeometry();
   void cleanGeometry();
+  // milliseconds the workers spent generating, summed over the threads
+  double getGenerationTime();
+  int getGenerationThreads();
 };
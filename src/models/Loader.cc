@@ -1,63 +1,222 @@
 // Loader.cc
 #include "Loader.h"
 #include "glPrerequisites.h"
+#include <renderEngine/GLState.h>
+#include <renderEngine/GpuResources.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 using std::vector;
 
-vector<unsigned int> Loader::vaos;
-vector<unsigned int> Loader::vbos;
+// 12 bytes instead of 24 for float positions and normals, the color is only
+// uploaded for baked models
+struct MeshVertex {
+  uint16_t position[4];
+  uint32_t normal;
+  uint32_t color;
+};
+
+struct DepthVertex {
+  uint16_t position[4];
+};
+
+// 16 bytes instead of 24 for float positions and data
+struct IndexedVertex {
+  int16_t position[4];
+  uint16_t data[4];
+};
 
 RawModel* Loader::loadToVAO(vector<float>& data1, int data1Dimension, vector<float>& data2, int data2Dimension, vector<unsigned int>& indices) {
-  unsigned int vaoID = createVAO();
-  bindIndicesBuffer(indices);
-  storeDataInAttributeList(0, data1Dimension, data1);
-  storeDataInAttributeList(1, data2Dimension, data2);
-  return new RawModel(vaoID, indices.size());
+  RawModel* model = new RawModel(createVAO(), indices.size());
+  model->addBuffer(bindIndicesBuffer(indices));
+  model->addBuffer(storeDataInAttributeList(0, data1Dimension, data1));
+  model->addBuffer(storeDataInAttributeList(1, data2Dimension, data2));
+  return model;
 }
 
 RawModel* Loader::loadToVAO(vector<float>& data1, int data1Dimension, vector<float>& data2, int data2Dimension) {
-  unsigned int vaoID = createVAO();
-  storeDataInAttributeList(0, data1Dimension, data1);
-  storeDataInAttributeList(1, data2Dimension, data2);
-  return new RawModel(vaoID, data1.size());
+  RawModel* model = new RawModel(createVAO(), data1.size() / data1Dimension);
+  model->addBuffer(storeDataInAttributeList(0, data1Dimension, data1));
+  model->addBuffer(storeDataInAttributeList(1, data2Dimension, data2));
+  return model;
 }
 
 RawModel* Loader::loadToVAO(vector<float>& data, int dimension) {
-  unsigned int vaoID = createVAO();
-  storeDataInAttributeList(0, dimension, data);
-  return new RawModel(vaoID, data.size(), 1);
+  RawModel* model = new RawModel(createVAO(), data.size() / dimension);
+  model->addBuffer(storeDataInAttributeList(0, dimension, data));
+  return model;
+}
+
+static float boundingRadius(const vector<float>& positions) {
+  float radius = 0.0f;
+  for (int i = 0; i + 2 < positions.size(); i += 3) {
+    radius = std::max(radius, glm::length(glm::vec3(positions[i], positions[i + 1], positions[i + 2])));
+  }
+  return radius;
+}
+
+RawModel* Loader::loadMeshToVAO(const vector<float>& positions, const vector<float>& normals, const vector<float>& colors) {
+  int vertexCount = positions.size() / 3;
+  bool hasColor = !colors.empty();
+  int stride = hasColor ? sizeof(MeshVertex) : offsetof(MeshVertex, color);
+  vector<MeshVertex> vertices(vertexCount);
+  vector<DepthVertex> depthVertices(vertexCount);
+  for (int i = 0; i < vertexCount; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      vertices[i].position[j] = glm::packHalf1x16(positions[i * 3 + j]);
+      depthVertices[i].position[j] = vertices[i].position[j];
+    }
+    vertices[i].position[3] = depthVertices[i].position[3] = 0;
+    glm::vec3 normal(normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2]);
+    vertices[i].normal = glm::packSnorm3x10_1x2(glm::vec4(glm::normalize(normal), 0.0f));
+    if (hasColor)
+      vertices[i].color = glm::packUnorm4x8(glm::vec4(colors[i * 4], colors[i * 4 + 1], colors[i * 4 + 2], colors[i * 4 + 3]));
+  }
+  // without colors the vertices are packed tightly to 12 bytes
+  vector<uint8_t> buffer(vertexCount * stride);
+  for (int i = 0; i < vertexCount; ++i) {
+    memcpy(&buffer[i * stride], &vertices[i], stride);
+  }
+
+  RawModel* model = new RawModel(createVAO(), vertexCount);
+  model->addBuffer(storeInterleavedData(&buffer.front(), buffer.size()));
+  glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, stride, (void*) offsetof(MeshVertex, position));
+  glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*) offsetof(MeshVertex, normal));
+  glEnableVertexAttribArray(0);
+  glEnableVertexAttribArray(1);
+  if (hasColor) {
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*) offsetof(MeshVertex, color));
+    glEnableVertexAttribArray(2);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  model->setDepthVao(createVAO());
+  model->addBuffer(storeInterleavedData(&depthVertices.front(), depthVertices.size() * sizeof(DepthVertex)));
+  glVertexAttribPointer(0, 3, GL_HALF_FLOAT, GL_FALSE, sizeof(DepthVertex), (void*) 0);
+  glEnableVertexAttribArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  model->setBoundingRadius(boundingRadius(positions));
+  return model;
 }
 
-void Loader::clean() {
-  for (int i = 0; i < vaos.size(); ++i) {
-    glDeleteVertexArrays(1, &vaos[i]);
+RawModel* Loader::loadIndexedToVAO(const vector<float>& positions, const vector<float>& data, const vector<unsigned int>& indices) {
+  int vertexCount = positions.size() / 3;
+  float scale = 0.0f;
+  for (float coordinate : positions) {
+    scale = std::max(scale, glm::abs(coordinate));
   }
-  for (int i = 0; i < vaos.size(); ++i) {
-    glDeleteBuffers(1, &vbos[i]);
+  scale = scale > 0.0f ? scale : 1.0f;
+
+  vector<IndexedVertex> vertices(vertexCount);
+  for (int i = 0; i < vertexCount; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      vertices[i].position[j] = (int16_t)glm::packSnorm1x16(positions[i * 3 + j] / scale);
+      vertices[i].data[j] = glm::packHalf1x16(data[i * 3 + j]);
+    }
+    vertices[i].position[3] = 0;
+    vertices[i].data[3] = 0;
   }
+
+  RawModel* model = new RawModel(createVAO(), indices.size());
+  unsigned int indexType;
+  model->addBuffer(bindIndicesBuffer(indices, vertexCount, indexType));
+  model->addBuffer(storeInterleavedData(&vertices.front(), vertices.size() * sizeof(IndexedVertex)));
+  glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(IndexedVertex), (void*) offsetof(IndexedVertex, position));
+  glVertexAttribPointer(1, 3, GL_HALF_FLOAT, GL_FALSE, sizeof(IndexedVertex), (void*) offsetof(IndexedVertex, data));
+  glEnableVertexAttribArray(0);
+  glEnableVertexAttribArray(1);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  model->setIndexType(indexType);
+  model->setPositionScale(scale);
+  model->setBoundingRadius(boundingRadius(positions));
+  return model;
 }
 
-unsigned int Loader::createVAO() {
-  unsigned int vaoID;
-  glGenVertexArrays(1, &vaoID);
-  vaos.push_back(vaoID);
-  glBindVertexArray(vaoID);
-  return vaoID;
+GpuHandle Loader::createEmptyVBO(int byteSize) {
+  return createVBO(nullptr, byteSize, GL_STREAM_DRAW);
 }
 
-void Loader::storeDataInAttributeList(unsigned int attrubuteNumber, int coordinateSize, vector<float>& data) {
-  unsigned int vboID;
-  glGenBuffers(1, &vboID);
-  vbos.push_back(vboID);
+void Loader::updateVBO(unsigned int vboID, int byteOffset, int byteSize, const void* data) {
   glBindBuffer(GL_ARRAY_BUFFER, vboID);
-  glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), &data.front(), GL_STATIC_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, byteOffset, byteSize, data);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+RawModel* Loader::loadStreamToVAO(const GpuHandle& vbo, int stride, const vector<StreamAttribute>& attributes) {
+  RawModel* model = new RawModel(createVAO(), 0);
+  model->addBuffer(vbo);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo.getID());
+  for (const StreamAttribute& attribute : attributes) {
+    glVertexAttribPointer(attribute.attribute, attribute.dataSize, attribute.type, attribute.normalized ? GL_TRUE : GL_FALSE,
+                          stride, (void*) (intptr_t) attribute.byteOffset);
+    glEnableVertexAttribArray(attribute.attribute);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return model;
+}
+
+void Loader::addInstancedAttribute(unsigned int vaoID, unsigned int vboID, unsigned int attribute, int dataSize, int instanceByteSize, int byteOffset) {
+  GLState::theOne().bindVertexArray(vaoID);
+  glBindBuffer(GL_ARRAY_BUFFER, vboID);
+  glVertexAttribPointer(attribute, dataSize, GL_FLOAT, GL_FALSE, instanceByteSize, (void*) (intptr_t) byteOffset);
+  glVertexAttribDivisor(attribute, 1);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+GpuHandle Loader::createVAO() {
+  GpuHandle vao = GpuResources::theOne().createVertexArray();
+  GLState::theOne().bindVertexArray(vao.getID());
+  return vao;
+}
+
+// buffers may come from the pool and be larger than asked for, so the data
+// is always written with a sub data upload
+GpuHandle Loader::createVBO(const void* data, long long byteSize, unsigned int usage) {
+  GpuHandle vbo = GpuResources::theOne().createBuffer(byteSize, usage);
+  if (data)
+    GpuResources::upload(vbo, data, byteSize);
+  return vbo;
+}
+
+GpuHandle Loader::storeDataInAttributeList(unsigned int attrubuteNumber, int coordinateSize, vector<float>& data) {
+  GpuHandle vbo = createVBO(&data.front(), data.size() * sizeof(float), GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo.getID());
   glVertexAttribPointer(attrubuteNumber, coordinateSize, GL_FLOAT, GL_FALSE, 0, (void*) 0);
+  glEnableVertexAttribArray(attrubuteNumber);
   glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return vbo;
+}
+
+// leaves the vbo bound for the attribute pointers that follow
+GpuHandle Loader::storeInterleavedData(const void* data, int byteSize) {
+  GpuHandle vbo = createVBO(data, byteSize, GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo.getID());
+  return vbo;
+}
+
+GpuHandle Loader::bindIndicesBuffer(const vector<unsigned int>& indices, int vertexCount, unsigned int& indexType) {
+  GpuHandle ebo;
+  if (vertexCount > 0xffff + 1) {
+    ebo = createVBO(&indices.front(), indices.size() * sizeof(unsigned int), GL_STATIC_DRAW);
+    indexType = GL_UNSIGNED_INT;
+  } else {
+    vector<uint16_t> shortIndices(indices.begin(), indices.end());
+    ebo = createVBO(&shortIndices.front(), shortIndices.size() * sizeof(uint16_t), GL_STATIC_DRAW);
+    indexType = GL_UNSIGNED_SHORT;
+  }
+  // recorded in the bound vao
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo.getID());
+  return ebo;
 }
 
-void Loader::bindIndicesBuffer(vector<unsigned int>& indices) {
-  unsigned int vboID;
-  glGenBuffers(1, &vboID);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vboID);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices.front(), GL_STATIC_DRAW);
+GpuHandle Loader::bindIndicesBuffer(vector<unsigned int>& indices) {
+  GpuHandle ebo = createVBO(&indices.front(), indices.size() * sizeof(unsigned int), GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo.getID());
+  return ebo;
 }
@@ -4,20 +4,44 @@
 #include <vector>
 using std::vector;
 
+// one interleaved attribute of a stream vbo
+struct StreamAttribute {
+  unsigned int attribute;
+  int dataSize;
+  unsigned int type;
+  bool normalized;
+  int byteOffset;
+};
+
+// the models own their vaos and vbos through GpuHandles, so deleting a
+// model frees its buffers, or returns them to the GpuResources pool
 class Loader {
 private:
-  static vector<unsigned int> vaos;
-  static vector<unsigned int> vbos;
-
-  static unsigned int createVAO();
-  static void storeDataInAttributeList(unsigned int attrubuteNumber, int coordinateSize, vector<float>& data);
-  static void bindIndicesBuffer(vector<unsigned int>& indices);
+  static GpuHandle createVAO();
+  static GpuHandle createVBO(const void* data, long long byteSize, unsigned int usage);
+  static GpuHandle storeDataInAttributeList(unsigned int attrubuteNumber, int coordinateSize, vector<float>& data);
+  static GpuHandle bindIndicesBuffer(vector<unsigned int>& indices);
+  // 16-bit indices when vertexCount allows it, the type is stored in indexType
+  static GpuHandle bindIndicesBuffer(const vector<unsigned int>& indices, int vertexCount, unsigned int& indexType);
+  static GpuHandle storeInterleavedData(const void* data, int byteSize);
 
 public:
-  static void clean();
 
   static RawModel* loadToVAO(vector<float>& data1, int data1Dimension, vector<float>& data2, int data2Dimension, vector<unsigned int>& indices);
   static RawModel* loadToVAO(vector<float>& data1, int data1Dimension, vector<float>& data2, int data2Dimension);
   static RawModel* loadToVAO(vector<float>& data, int dimension);
+  // half float positions, packed normals and optional rgba8 colors, with a
+  // position-only stream for depth passes
+  static RawModel* loadMeshToVAO(const vector<float>& positions, const vector<float>& normals,
+                                 const vector<float>& colors = vector<float>());
+  // snorm16 positions and half float data, 16-bit indices when they fit
+  static RawModel* loadIndexedToVAO(const vector<float>& positions, const vector<float>& data, const vector<unsigned int>& indices);
+
+  static GpuHandle createEmptyVBO(int byteSize);
+  static void updateVBO(unsigned int vboID, int byteOffset, int byteSize, const void* data);
+  // a vao reading interleaved attributes from a vbo made by createEmptyVBO,
+  // the vertex count is left to the draw call; the model shares the vbo
+  static RawModel* loadStreamToVAO(const GpuHandle& vbo, int stride, const vector<StreamAttribute>& attributes);
+  static void addInstancedAttribute(unsigned int vaoID, unsigned int vboID, unsigned int attribute, int dataSize, int instanceByteSize, int byteOffset);
 };
 
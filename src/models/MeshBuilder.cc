@@ -0,0 +1,24 @@
+// MeshBuilder.cc
+#include "MeshBuilder.h"
+#include "Loader.h"
+using std::vector;
+
+void MeshBuilder::add(const MeshData& mesh, const glm::mat4& transformation, glm::vec3 color, float opacity) {
+  glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(transformation)));
+  for (int i = 0; i + 2 < mesh.positions.size(); i += 3) {
+    glm::vec4 position = transformation * glm::vec4(mesh.positions[i], mesh.positions[i + 1], mesh.positions[i + 2], 1.0f);
+    glm::vec3 normal = normalMatrix * glm::vec3(mesh.normals[i], mesh.normals[i + 1], mesh.normals[i + 2]);
+    positions.insert(positions.end(), { position.x, position.y, position.z });
+    normals.insert(normals.end(), { normal.x, normal.y, normal.z });
+    colors.insert(colors.end(), { color.r, color.g, color.b, opacity });
+  }
+}
+
+MeshData MeshBuilder::getMesh() const {
+  MeshData mesh = { positions, normals, colors };
+  return mesh;
+}
+
+RawModel* MeshBuilder::build() {
+  return Loader::loadMeshToVAO(positions, normals, colors);
+}
@@ -0,0 +1,18 @@
+// MeshBuilder.h
+#pragma once
+#include "Geometry.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+// merges rigid parts into one vertex colored model, drawn with a single transformation
+class MeshBuilder {
+private:
+  std::vector<float> positions;
+  std::vector<float> normals;
+  std::vector<float> colors;
+public:
+  void add(const MeshData& mesh, const glm::mat4& transformation, glm::vec3 color, float opacity = 1.0f);
+  // the merged mesh, without touching gl
+  MeshData getMesh() const;
+  RawModel* build();
+};
@@ -1,27 +1,92 @@
 // RawModel.cc
 #include "RawModel.h"
 #include "glPrerequisites.h"
+#include <renderEngine/GLState.h>
 
-RawModel::RawModel(unsigned int vaoID, unsigned int vertexCount, int vbos): vbos(vbos), vaoID(vaoID), vertexCount(vertexCount) { }
+RawModel::RawModel(const GpuHandle& vao, unsigned int vertexCount):
+  vao(vao),
+  vertexCount(vertexCount),
+  indexType(GL_UNSIGNED_INT),
+  positionScale(1.0f),
+  boundingRadius(1.0f)
+{
+  lods.push_back({ 0, vertexCount, 0.0f });
+}
 
 unsigned int RawModel::getVaoID() const {
-  return vaoID;
+  return vao.getID();
 }
 
 unsigned int RawModel::getVertexCount() const {
   return vertexCount;
 }
 
-void RawModel::bind() {
-  glBindVertexArray(vaoID);
-  for (int i = 0; i < vbos; ++i) {
-    glEnableVertexAttribArray(i);
+unsigned int RawModel::getIndexType() const {
+  return indexType;
+}
+
+void RawModel::setIndexType(unsigned int indexType) {
+  this->indexType = indexType;
+}
+
+void RawModel::setDepthVao(const GpuHandle& depthVao) {
+  this->depthVao = depthVao;
+}
+
+void RawModel::addBuffer(const GpuHandle& buffer) {
+  buffers.push_back(buffer);
+}
+
+float RawModel::getPositionScale() const {
+  return positionScale;
+}
+
+void RawModel::setPositionScale(float positionScale) {
+  this->positionScale = positionScale;
+}
+
+float RawModel::getBoundingRadius() const {
+  return boundingRadius;
+}
+
+void RawModel::setBoundingRadius(float boundingRadius) {
+  this->boundingRadius = boundingRadius;
+}
+
+unsigned int RawModel::getIndexSize() const {
+  switch (indexType) {
+    case GL_UNSIGNED_BYTE: return 1;
+    case GL_UNSIGNED_SHORT: return 2;
+    default: return 4;
   }
 }
 
-void RawModel::unbind(int vbos) {
-  for (int i = 0; i < vbos; ++i) {
-    glDisableVertexAttribArray(i);
+void RawModel::setLods(const std::vector<LodLevel>& lods) {
+  this->lods = lods;
+}
+
+int RawModel::getLodCount() const {
+  return lods.size();
+}
+
+const LodLevel& RawModel::getLod(int lod) const {
+  return lods[lod];
+}
+
+int RawModel::selectLod(float screenSize, int bias) const {
+  int last = lods.size() - 1;
+  int lod = 0;
+  while (lod < last && screenSize < lods[lod].minScreenSize) {
+    ++lod;
   }
-  glBindVertexArray(0);
+  lod += bias;
+  return lod < last ? lod : last;
+}
+
+void RawModel::bind() {
+  GLState::theOne().bindVertexArray(vao.getID());
+}
+
+void RawModel::bindDepth() {
+  GLState::theOne().bindVertexArray(depthVao.isValid() ? depthVao.getID() : vao.getID());
 }
@@ -1,17 +1,56 @@
 // RawModel.h
 #pragma once
+#include <renderEngine/GpuResources.h>
+#include <vector>
 
+// a contiguous range of vertices (or indices) holding one level of detail
+struct LodLevel {
+  unsigned int first;
+  unsigned int count;
+  // smallest projected size, as a fraction of the screen height, the level is used for
+  float minScreenSize;
+};
+
+// shadow passes draw this many levels coarser than the main pass
+const int SHADOW_LOD_BIAS = 1;
+
+// owns its vaos and every buffer they read from, copies share them
 class RawModel {
 private:
-  unsigned int vaoID;
+  GpuHandle vao;
+  // position-only stream for depth passes, empty if the model has none
+  GpuHandle depthVao;
+  std::vector<GpuHandle> buffers;
   unsigned int vertexCount;
-  int vbos;
+  unsigned int indexType;
+  float positionScale;
+  float boundingRadius;
+  std::vector<LodLevel> lods;
 public:
-  RawModel(unsigned int vaoID, unsigned int vertexCount, int vbos = 2);
+  RawModel(const GpuHandle& vao, unsigned int vertexCount);
 
   unsigned int getVaoID() const;
   unsigned int getVertexCount() const;
+  unsigned int getIndexType() const;
+  void setIndexType(unsigned int indexType);
+  void setDepthVao(const GpuHandle& depthVao);
+  // keeps a buffer alive as long as the model, e.g. one added to the vao later
+  void addBuffer(const GpuHandle& buffer);
+  // normalized positions are stored divided by this scale
+  float getPositionScale() const;
+  void setPositionScale(float positionScale);
+  // radius of the bounding sphere around the model origin
+  float getBoundingRadius() const;
+  void setBoundingRadius(float boundingRadius);
+  unsigned int getIndexSize() const;
+
+  // levels are ordered from finest to coarsest, a model without a chain has one level
+  void setLods(const std::vector<LodLevel>& lods);
+  int getLodCount() const;
+  const LodLevel& getLod(int lod) const;
+  int selectLod(float screenSize, int bias = 0) const;
 
+  // the attribute arrays are enabled once by the Loader and live in the vao
   void bind();
-  static void unbind(int vbos = 2);
+  void bindDepth();
 };
@@ -1,5 +1,7 @@
 // DisplayManager.cc
 #include "DisplayManager.h"
+#include "HeadlessDisplay.h"
+#include "GLState.h"
 #include <GLFW/glfw3.h>
 #include <io/KeyboardManager.h>
 #include <common.h>
@@ -13,7 +15,14 @@ GLFWwindow* DisplayManager::window;
 
 void keyCallback(GLFWwindow* window, int key, int scancodem, int action, int mode);
 
-void DisplayManager::createDisplay() {
+bool DisplayManager::createDisplay() {
+  if (HEADLESS::ENABLED) {
+    if (!HeadlessDisplay::createDisplay())
+      return false;
+    initState();
+    return true;
+  }
+
   glfwInit();
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -33,60 +42,115 @@ void DisplayManager::createDisplay() {
     cout << "====================================\n";
     cout << "ERROR::GLFW: Failed to create window\n";
     cout << "====================================\n";
+    return false;
   }
 
   glfwGetFramebufferSize(window, &ACTUAL_WIDTH, &ACTUAL_HEIGHT);
   glfwMakeContextCurrent(window);
 
   glfwSetKeyCallback(window, keyCallback);
+  if (STRESS::ENABLED)
+    glfwSwapInterval(0);
   //glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_HIDDEN);
 
   if (gladLoadGL() == 0) {
     cout << "======================================\n";
     cout << "ERROR::GLAD: Failed to initialize glad\n";
     cout << "======================================\n";
+    return false;
   }
 
-  glEnable(GL_MULTISAMPLE);
-  glEnable(GL_DEPTH_TEST);
+  initState();
+  return true;
+}
+
+void DisplayManager::initState() {
+  GLState& state = GLState::theOne();
+  state.invalidate();
+  state.enable(GL_MULTISAMPLE);
+  state.enable(GL_DEPTH_TEST);
   // alpha blending
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  state.enable(GL_BLEND);
+  state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
   // face culling
-  glEnable(GL_CULL_FACE);
+  state.enable(GL_CULL_FACE);
   glFrontFace(GL_CW);
-  glCullFace(GL_BACK);
+  state.cullFace(GL_BACK);
 }
 
 void DisplayManager::prepareDisplay() {
+  if (HEADLESS::ENABLED)
+    return;
   glfwPollEvents();
 }
 
 void DisplayManager::updateDisplay() {
+  if (HEADLESS::ENABLED) {
+    HeadlessDisplay::updateDisplay();
+    return;
+  }
   glfwSwapBuffers(window);
 }
 
 void DisplayManager::cleanDisplay() {
+  if (HEADLESS::ENABLED) {
+    HeadlessDisplay::cleanDisplay();
+    return;
+  }
   glfwTerminate();
 }
 
+void DisplayManager::closeDisplay() {
+  if (HEADLESS::ENABLED) {
+    HeadlessDisplay::closeDisplay();
+    return;
+  }
+  glfwSetWindowShouldClose(window, GL_TRUE);
+}
+
 bool DisplayManager::shouldCloseDisplay() {
+  if (HEADLESS::ENABLED)
+    return HeadlessDisplay::shouldCloseDisplay();
   return glfwWindowShouldClose(window);
 }
 
 long double DisplayManager::getTime() {
+  if (HEADLESS::ENABLED)
+    return HeadlessDisplay::getTime();
   return glfwGetTime();
 }
 
 void DisplayManager::getCursorPos(double* x, double* y) {
+  // headless runs fly straight through the middle of the screen
+  if (HEADLESS::ENABLED) {
+    *x = 0.5 * WIDTH;
+    *y = 0.5 * HEIGHT;
+    return;
+  }
   glfwGetCursorPos(window, x, y);
 }
 
 void DisplayManager::setTitle(const char* title) {
+  if (HEADLESS::ENABLED)
+    return;
   glfwSetWindowTitle(window, title);
 }
 
+unsigned int DisplayManager::getFramebuffer() {
+  return HEADLESS::ENABLED ? HeadlessDisplay::getFramebuffer() : 0;
+}
+
+void* DisplayManager::getProcAddress(const char* name) {
+  if (HEADLESS::ENABLED)
+    return HeadlessDisplay::getProcAddress(name);
+  return (void*)glfwGetProcAddress(name);
+}
+
+int DisplayManager::getExitCode() {
+  return HEADLESS::ENABLED ? HeadlessDisplay::getExitCode() : 0;
+}
+
 void keyCallback(GLFWwindow* window, int key, int scancodem, int action, int mode) {
   if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) {
     glfwSetWindowShouldClose(window, GL_TRUE);
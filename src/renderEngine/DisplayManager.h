@@ -7,14 +7,23 @@ struct GLFWwindow;
 class DisplayManager {
 private:
   static GLFWwindow* window;
+
+  static void initState();
 public:
-  static void createDisplay();
+  // false if no context could be created
+  static bool createDisplay();
   static void prepareDisplay();
   static void updateDisplay();
   static void cleanDisplay();
+  static void closeDisplay();
   static bool shouldCloseDisplay();
 
   static long double getTime();
   static void getCursorPos(double* x, double* y);
   static void setTitle(const char* title);
+  // the framebuffer the scene is rendered to, 0 unless headless
+  static unsigned int getFramebuffer();
+  // entry points glad does not load, e.g. from extensions
+  static void* getProcAddress(const char* name);
+  static int getExitCode();
 };
@@ -0,0 +1,279 @@
+// FrameCapture.cc
+#include "FrameCapture.h"
+#include "DisplayManager.h"
+#include "glPrerequisites.h"
+#include <common.h>
+#include <utils/MemoryTracker.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+using std::cout;
+using std::vector;
+
+// png with stored (uncompressed) deflate blocks, cheap enough for the writer
+// thread to keep up and needs no zlib
+static uint32_t crcTable[256];
+
+static void initCrcTable() {
+  for (uint32_t n = 0; n < 256; ++n) {
+    uint32_t c = n;
+    for (int k = 0; k < 8; ++k)
+      c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+    crcTable[n] = c;
+  }
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size) {
+  for (size_t i = 0; i < size; ++i)
+    crc = crcTable[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  return crc;
+}
+
+static void putBigEndian(vector<uint8_t>& out, uint32_t value) {
+  for (int shift = 24; shift >= 0; shift -= 8)
+    out.push_back((value >> shift) & 0xff);
+}
+
+static void putChunk(std::ofstream& file, const char* type, const vector<uint8_t>& data) {
+  vector<uint8_t> chunk;
+  putBigEndian(chunk, data.size());
+  chunk.insert(chunk.end(), type, type + 4);
+  chunk.insert(chunk.end(), data.begin(), data.end());
+  uint32_t crc = crc32(0xffffffffu, &chunk[4], chunk.size() - 4) ^ 0xffffffffu;
+  putBigEndian(chunk, crc);
+  file.write((const char*)&chunk.front(), chunk.size());
+}
+
+static bool writePNG(const char* fileName, int width, int height, const vector<uint8_t>& rgb) {
+  std::ofstream file(fileName, std::ios::binary);
+  if (!file.is_open())
+    return false;
+  const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+  file.write((const char*)signature, 8);
+
+  vector<uint8_t> header;
+  putBigEndian(header, width);
+  putBigEndian(header, height);
+  // 8 bit rgb, deflate, adaptive filtering, no interlace
+  const uint8_t format[5] = { 8, 2, 0, 0, 0 };
+  header.insert(header.end(), format, format + 5);
+  putChunk(file, "IHDR", header);
+
+  // every row starts with filter type 0
+  int rowSize = width * 3;
+  vector<uint8_t> raw;
+  raw.reserve((rowSize + 1) * height);
+  for (int y = 0; y < height; ++y) {
+    raw.push_back(0);
+    raw.insert(raw.end(), rgb.begin() + y * rowSize, rgb.begin() + (y + 1) * rowSize);
+  }
+
+  vector<uint8_t> zlib = { 0x78, 0x01 };
+  uint32_t a = 1, b = 0;
+  for (uint8_t byte : raw) {
+    a = (a + byte) % 65521;
+    b = (b + a) % 65521;
+  }
+  for (size_t offset = 0; offset < raw.size(); offset += 65535) {
+    size_t size = std::min<size_t>(65535, raw.size() - offset);
+    zlib.push_back(offset + size == raw.size() ? 1 : 0);
+    zlib.push_back(size & 0xff);
+    zlib.push_back(size >> 8);
+    zlib.push_back(~size & 0xff);
+    zlib.push_back((~size >> 8) & 0xff);
+    zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + size);
+  }
+  putBigEndian(zlib, (b << 16) | a);
+  putChunk(file, "IDAT", zlib);
+  putChunk(file, "IEND", vector<uint8_t>());
+  return file.good();
+}
+
+FrameCapture::FrameCapture():
+  enabled(CAPTURE::OUTPUT != nullptr),
+  width(ACTUAL_WIDTH),
+  height(ACTUAL_HEIGHT),
+  next(0),
+  frame(0),
+  captured(0),
+  dropped(0),
+  quit(false)
+{
+  if (!enabled)
+    return;
+
+  if (!CAPTURE::PNG) {
+    rawFile.open(CAPTURE::OUTPUT, std::ios::binary);
+    if (!rawFile.is_open()) {
+      cout << "==================================================\n";
+      cout << "ERROR::CAPTURE: Failed to open " << CAPTURE::OUTPUT;
+      cout << "\n==================================================\n";
+      enabled = false;
+      return;
+    }
+  }
+  initCrcTable();
+
+  for (int i = 0; i < RING_SIZE; ++i) {
+    glGenBuffers(1, &slots[i].pboID);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slots[i].pboID);
+    glBufferData(GL_PIXEL_PACK_BUFFER, width * height * 4, NULL, GL_STREAM_READ);
+    slots[i].fence = nullptr;
+    slots[i].frame = 0;
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  MemoryTracker::theOne().allocate(MEMORY_GPU_BUFFERS, (long long)RING_SIZE * width * height * 4);
+
+  for (int i = 0; i < MAX_PENDING; ++i)
+    freeBuffers.push_back(vector<uint8_t>(width * height * 4));
+  writer = std::thread(&FrameCapture::writerLoop, this);
+}
+
+FrameCapture::~FrameCapture() {
+  finish();
+}
+
+void FrameCapture::capture() {
+  if (!enabled)
+    return;
+
+  collect(false);
+
+  if (frame++ % std::max(CAPTURE::INTERVAL, 1) != 0)
+    return;
+
+  // the oldest slot is reused; if its readback has not landed yet the gpu
+  // is behind and this frame is skipped
+  Slot& slot = slots[next];
+  if (slot.fence) {
+    ++dropped;
+    return;
+  }
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, DisplayManager::getFramebuffer());
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pboID);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  slot.frame = frame - 1;
+  next = (next + 1) % RING_SIZE;
+}
+
+void FrameCapture::collect(bool wait) {
+  // slots complete in submission order, starting with the one after the newest
+  for (int i = 0; i < RING_SIZE; ++i) {
+    Slot& slot = slots[(next + i) % RING_SIZE];
+    if (!slot.fence)
+      continue;
+    GLsync fence = (GLsync)slot.fence;
+    GLenum status = glClientWaitSync(fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000000ull : 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+      break;
+    glDeleteSync(fence);
+    slot.fence = nullptr;
+
+    vector<uint8_t> pixels;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      if (!freeBuffers.empty()) {
+        pixels.swap(freeBuffers.back());
+        freeBuffers.pop_back();
+      }
+    }
+    if (pixels.empty()) {
+      ++dropped;
+      continue;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pboID);
+    void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, pixels.size(), GL_MAP_READ_BIT);
+    if (data) {
+      memcpy(&pixels.front(), data, pixels.size());
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      pending.push_back(Frame{ slot.frame, std::move(pixels) });
+    }
+    wake.notify_one();
+    ++captured;
+  }
+}
+
+void FrameCapture::writerLoop() {
+  for (;;) {
+    Frame frame;
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      wake.wait(guard, [this]() { return quit || !pending.empty(); });
+      if (pending.empty())
+        return;
+      frame = std::move(pending.front());
+      pending.pop_front();
+    }
+
+    writeFrame(frame);
+
+    std::lock_guard<std::mutex> guard(lock);
+    freeBuffers.push_back(std::move(frame.pixels));
+  }
+}
+
+void FrameCapture::writeFrame(const Frame& frame) {
+  // rgba rows from the bottom to rgb rows from the top
+  vector<uint8_t> rgb(width * height * 3);
+  for (int y = 0; y < height; ++y) {
+    const uint8_t* src = &frame.pixels[(height - 1 - y) * width * 4];
+    uint8_t* dst = &rgb[y * width * 3];
+    for (int x = 0; x < width; ++x) {
+      dst[x * 3] = src[x * 4];
+      dst[x * 3 + 1] = src[x * 4 + 1];
+      dst[x * 3 + 2] = src[x * 4 + 2];
+    }
+  }
+
+  if (!CAPTURE::PNG) {
+    rawFile.write((const char*)&rgb.front(), rgb.size());
+    return;
+  }
+
+  char fileName[512];
+  snprintf(fileName, sizeof(fileName), "%s_%06d.png", CAPTURE::OUTPUT, frame.frame);
+  if (!writePNG(fileName, width, height, rgb)) {
+    cout << "==================================================\n";
+    cout << "ERROR::CAPTURE: Failed to write " << fileName;
+    cout << "\n==================================================\n";
+  }
+}
+
+void FrameCapture::finish() {
+  if (!enabled)
+    return;
+  enabled = false;
+
+  collect(true);
+  for (int i = 0; i < RING_SIZE; ++i) {
+    if (slots[i].fence)
+      glDeleteSync((GLsync)slots[i].fence);
+    glDeleteBuffers(1, &slots[i].pboID);
+  }
+  MemoryTracker::theOne().release(MEMORY_GPU_BUFFERS, (long long)RING_SIZE * width * height * 4);
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    quit = true;
+  }
+  wake.notify_one();
+  writer.join();
+  rawFile.close();
+
+  cout << "CAPTURE: " << captured << " frames written, " << dropped << " dropped";
+  if (!CAPTURE::PNG)
+    cout << ", play with ffplay -f rawvideo -pixel_format rgb24 -video_size " << width << "x" << height << " " << CAPTURE::OUTPUT;
+  cout << "\n";
+}
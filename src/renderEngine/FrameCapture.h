@@ -0,0 +1,59 @@
+// FrameCapture.h
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// reads finished frames back through a ring of pixel buffer objects. Each
+// readback is guarded by a fence and only mapped once the fence has
+// signaled, so the render thread never waits on the gpu; a worker thread
+// writes the frames as raw rgb24 video or a png sequence. When every
+// buffer is still in flight the frame is dropped instead of stalling
+class FrameCapture {
+private:
+  static const int RING_SIZE = 3;
+  // frames waiting for the writer, further frames are dropped
+  static const int MAX_PENDING = 8;
+
+  struct Slot {
+    unsigned int pboID;
+    void* fence;
+    int frame;
+  };
+
+  struct Frame {
+    int frame;
+    std::vector<uint8_t> pixels;
+  };
+
+  bool enabled;
+  int width, height;
+  Slot slots[RING_SIZE];
+  int next;
+  int frame;
+  int captured, dropped;
+
+  std::thread writer;
+  std::mutex lock;
+  std::condition_variable wake;
+  std::deque<Frame> pending;
+  std::vector<std::vector<uint8_t>> freeBuffers;
+  bool quit;
+  std::ofstream rawFile;
+
+  void collect(bool wait);
+  void writerLoop();
+  void writeFrame(const Frame& frame);
+public:
+  FrameCapture();
+  ~FrameCapture();
+
+  // queues a readback of the framebuffer DisplayManager renders to
+  void capture();
+  // waits for the outstanding readbacks and the writer
+  void finish();
+};
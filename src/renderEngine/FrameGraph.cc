@@ -0,0 +1,388 @@
+// FrameGraph.cc
+#include "FrameGraph.h"
+#include "glPrerequisites.h"
+#include "GLState.h"
+#include <algorithm>
+#include <iostream>
+using std::cout;
+using std::vector;
+
+FrameGraph::Pass::Pass(const char* name, std::function<void()> execute):
+  name(name),
+  execute(execute),
+  depthWrite(INVALID),
+  framebufferWrite(INVALID),
+  clearMask(0),
+  sideEffect(false),
+  live(false)
+{}
+
+FrameGraph::Pass& FrameGraph::Pass::read(Resource resource, int unit) {
+  reads.push_back(std::make_pair(resource, unit));
+  return *this;
+}
+
+FrameGraph::Pass& FrameGraph::Pass::writeColor(Resource texture) {
+  colorWrites.push_back(texture);
+  return *this;
+}
+
+FrameGraph::Pass& FrameGraph::Pass::writeDepth(Resource texture) {
+  depthWrite = texture;
+  return *this;
+}
+
+FrameGraph::Pass& FrameGraph::Pass::write(Resource framebuffer) {
+  framebufferWrite = framebuffer;
+  return *this;
+}
+
+FrameGraph::Pass& FrameGraph::Pass::clear(unsigned int mask) {
+  clearMask = mask;
+  return *this;
+}
+
+FrameGraph::Pass& FrameGraph::Pass::keep() {
+  sideEffect = true;
+  return *this;
+}
+
+static vector<FrameGraph::Resource> getWrites(const vector<FrameGraph::Resource>& colorWrites,
+                                              FrameGraph::Resource depthWrite, FrameGraph::Resource framebufferWrite) {
+  vector<FrameGraph::Resource> writes(colorWrites);
+  if (depthWrite != FrameGraph::INVALID)
+    writes.push_back(depthWrite);
+  if (framebufferWrite != FrameGraph::INVALID)
+    writes.push_back(framebufferWrite);
+  return writes;
+}
+
+FrameGraph::FrameGraph(): timed(false), frameIndex(0) {
+  reset();
+}
+
+FrameGraph::~FrameGraph() {
+  clean();
+}
+
+void FrameGraph::clean() {
+  // the handles free the objects
+  framebuffers.clear();
+  texturePool.clear();
+  timer.clean();
+}
+
+void FrameGraph::reset() {
+  resources.clear();
+  passes.clear();
+  order.clear();
+  stats = Stats();
+}
+
+FrameGraph::Resource FrameGraph::importTexture(const char* name, unsigned int textureID, int width, int height) {
+  resources.push_back({ name, IMPORTED_TEXTURE, textureID, width, height, 0, -1, -1 });
+  return resources.size() - 1;
+}
+
+FrameGraph::Resource FrameGraph::importFramebuffer(const char* name, unsigned int fboID, int width, int height) {
+  resources.push_back({ name, IMPORTED_FRAMEBUFFER, fboID, width, height, 0, -1, -1 });
+  return resources.size() - 1;
+}
+
+FrameGraph::Resource FrameGraph::createTexture(const char* name, int width, int height, unsigned int internalFormat) {
+  resources.push_back({ name, TRANSIENT_TEXTURE, 0, width, height, internalFormat, -1, -1 });
+  return resources.size() - 1;
+}
+
+unsigned int FrameGraph::getTextureID(Resource texture) const {
+  return resources[texture].id;
+}
+
+FrameGraph::Pass& FrameGraph::addPass(const char* name, std::function<void()> execute) {
+  passes.push_back(Pass(name, execute));
+  return passes.back();
+}
+
+void FrameGraph::compile() {
+  stats.passes = passes.size();
+  cullPasses();
+  sortPasses();
+  allocateTransients();
+}
+
+void FrameGraph::cullPasses() {
+  // data flows along read-after-write and write-after-write edges; a pass
+  // stays if it has side effects, writes an imported resource, or feeds one
+  // that does
+  int count = passes.size();
+  vector<vector<int>> producers(count);
+  vector<int> lastWriter(resources.size(), -1);
+  for (int i = 0; i < count; ++i) {
+    Pass& pass = passes[i];
+    for (auto& read : pass.reads) {
+      if (lastWriter[read.first] >= 0)
+        producers[i].push_back(lastWriter[read.first]);
+    }
+    for (Resource resource : getWrites(pass.colorWrites, pass.depthWrite, pass.framebufferWrite)) {
+      if (lastWriter[resource] >= 0)
+        producers[i].push_back(lastWriter[resource]);
+      lastWriter[resource] = i;
+      if (resources[resource].kind != TRANSIENT_TEXTURE)
+        pass.sideEffect = true;
+    }
+    pass.live = false;
+  }
+
+  vector<int> stack;
+  for (int i = 0; i < count; ++i) {
+    if (passes[i].sideEffect) {
+      passes[i].live = true;
+      stack.push_back(i);
+    }
+  }
+  while (!stack.empty()) {
+    int i = stack.back();
+    stack.pop_back();
+    for (int producer : producers[i]) {
+      if (!passes[producer].live) {
+        passes[producer].live = true;
+        stack.push_back(producer);
+      }
+    }
+  }
+
+  for (Pass& pass : passes) {
+    if (!pass.live)
+      ++stats.culled;
+  }
+}
+
+void FrameGraph::sortPasses() {
+  // every edge points from an earlier declared pass to a later one, so the
+  // declaration order is always valid; the sort only moves independent
+  // passes next to others drawing into the same target
+  int count = passes.size();
+  vector<vector<int>> successors(count);
+  vector<int> incoming(count, 0);
+  vector<int> lastWriter(resources.size(), -1);
+  vector<vector<int>> readers(resources.size());
+  auto addEdge = [&](int from, int to) {
+    if (from < 0 || from == to || !passes[from].live)
+      return;
+    successors[from].push_back(to);
+    ++incoming[to];
+  };
+  for (int i = 0; i < count; ++i) {
+    Pass& pass = passes[i];
+    if (!pass.live)
+      continue;
+    for (auto& read : pass.reads)
+      addEdge(lastWriter[read.first], i);
+    for (Resource resource : getWrites(pass.colorWrites, pass.depthWrite, pass.framebufferWrite)) {
+      addEdge(lastWriter[resource], i);
+      for (int reader : readers[resource])
+        addEdge(reader, i);
+      readers[resource].clear();
+      lastWriter[resource] = i;
+    }
+    for (auto& read : pass.reads)
+      readers[read.first].push_back(i);
+  }
+
+  vector<int> ready;
+  for (int i = 0; i < count; ++i) {
+    if (passes[i].live && incoming[i] == 0)
+      ready.push_back(i);
+  }
+
+  vector<Resource> target;
+  order.clear();
+  while (!ready.empty()) {
+    // ready is kept in declaration order
+    int pick = 0;
+    for (int i = 0; i < ready.size(); ++i) {
+      const Pass& pass = passes[ready[i]];
+      vector<Resource> writes = getWrites(pass.colorWrites, pass.depthWrite, pass.framebufferWrite);
+      if (writes.empty() || writes == target) {
+        pick = i;
+        break;
+      }
+    }
+    int index = ready[pick];
+    ready.erase(ready.begin() + pick);
+
+    Pass& pass = passes[index];
+    vector<Resource> writes = getWrites(pass.colorWrites, pass.depthWrite, pass.framebufferWrite);
+    if (!writes.empty())
+      target = writes;
+    order.push_back(&pass);
+
+    for (int successor : successors[index]) {
+      if (--incoming[successor] == 0)
+        ready.insert(std::upper_bound(ready.begin(), ready.end(), successor), successor);
+    }
+  }
+}
+
+void FrameGraph::allocateTransients() {
+  for (int position = 0; position < order.size(); ++position) {
+    Pass& pass = *order[position];
+    vector<Resource> used = getWrites(pass.colorWrites, pass.depthWrite, pass.framebufferWrite);
+    for (auto& read : pass.reads)
+      used.push_back(read.first);
+    for (Resource resource : used) {
+      ResourceNode& node = resources[resource];
+      if (node.firstUse < 0)
+        node.firstUse = position;
+      node.lastUse = position;
+    }
+  }
+
+  vector<Resource> transients;
+  for (int i = 0; i < resources.size(); ++i) {
+    if (resources[i].kind == TRANSIENT_TEXTURE && resources[i].firstUse >= 0)
+      transients.push_back(i);
+  }
+  std::sort(transients.begin(), transients.end(), [this](Resource a, Resource b) {
+    return resources[a].firstUse < resources[b].firstUse;
+  });
+
+  // a pooled texture is free once the last pass using its previous tenant has run
+  for (PooledTexture& texture : texturePool)
+    texture.busyUntil = -1;
+  for (Resource resource : transients) {
+    ResourceNode& node = resources[resource];
+    PooledTexture* match = nullptr;
+    for (PooledTexture& texture : texturePool) {
+      if (texture.width == node.width && texture.height == node.height &&
+          texture.internalFormat == node.internalFormat && texture.busyUntil < node.firstUse) {
+        match = &texture;
+        break;
+      }
+    }
+    if (!match) {
+      bool depth = node.internalFormat == GL_DEPTH_COMPONENT16 || node.internalFormat == GL_DEPTH_COMPONENT24 ||
+                   node.internalFormat == GL_DEPTH_COMPONENT32F;
+      GpuHandle texture = GpuResources::theOne().createTexture(
+        MemoryTracker::textureBytes(node.internalFormat, node.width, node.height), MEMORY_FRAMEBUFFERS);
+      GLState::theOne().bindTexture(0, GL_TEXTURE_2D, texture.getID());
+      glTexImage2D(GL_TEXTURE_2D, 0, node.internalFormat, node.width, node.height, 0,
+                   depth ? GL_DEPTH_COMPONENT : GL_RGBA, depth ? GL_FLOAT : GL_UNSIGNED_BYTE, NULL);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      texturePool.push_back({ node.width, node.height, node.internalFormat, texture, -1 });
+      match = &texturePool.back();
+    }
+    match->busyUntil = node.lastUse;
+    node.id = match->texture.getID();
+    ++stats.transientTextures;
+  }
+  stats.physicalTextures = texturePool.size();
+}
+
+unsigned int FrameGraph::getFramebuffer(const Pass& pass) {
+  if (pass.framebufferWrite != INVALID)
+    return resources[pass.framebufferWrite].id;
+
+  vector<unsigned int> key;
+  for (Resource resource : pass.colorWrites)
+    key.push_back(resources[resource].id);
+  key.push_back(pass.depthWrite != INVALID ? resources[pass.depthWrite].id : 0);
+  auto it = framebuffers.find(key);
+  if (it != framebuffers.end())
+    return it->second.getID();
+
+  GpuHandle framebuffer = GpuResources::theOne().createFramebuffer();
+  unsigned int fboID = framebuffer.getID();
+  GLState::theOne().bindFramebuffer(fboID);
+  vector<unsigned int> drawBuffers;
+  for (int i = 0; i < pass.colorWrites.size(); ++i) {
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, key[i], 0);
+    drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+  }
+  if (pass.depthWrite != INVALID)
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, key.back(), 0);
+  if (drawBuffers.empty()) {
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+  } else {
+    glDrawBuffers(drawBuffers.size(), &drawBuffers.front());
+  }
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    cout << "==================================================\n";
+    cout << "ERROR::FRAMEGRAPH: Incomplete framebuffer for pass " << pass.name;
+    cout << "\n==================================================\n";
+  }
+  framebuffers[key] = framebuffer;
+  return fboID;
+}
+
+bool FrameGraph::getTargetSize(const Pass& pass, int& width, int& height) const {
+  Resource target = pass.framebufferWrite;
+  if (target == INVALID)
+    target = !pass.colorWrites.empty() ? pass.colorWrites[0] : pass.depthWrite;
+  if (target == INVALID)
+    return false;
+  width = resources[target].width;
+  height = resources[target].height;
+  return true;
+}
+
+void FrameGraph::execute() {
+  bool bound = false;
+  unsigned int currentFramebuffer = 0;
+  int currentWidth = -1, currentHeight = -1;
+  if (timed)
+    timer.beginFrame(frameIndex);
+  for (Pass* pass : order) {
+    if (timed)
+      timer.begin(pass->name);
+    int width, height;
+    if (getTargetSize(*pass, width, height)) {
+      unsigned int framebuffer = getFramebuffer(*pass);
+      if (!bound || framebuffer != currentFramebuffer) {
+        GLState::theOne().bindFramebuffer(framebuffer);
+        currentFramebuffer = framebuffer;
+        bound = true;
+        ++stats.framebufferSwitches;
+      }
+      if (width != currentWidth || height != currentHeight) {
+        GLState::theOne().viewport(width, height);
+        currentWidth = width;
+        currentHeight = height;
+        ++stats.viewportSwitches;
+      }
+      if (pass->clearMask)
+        glClear(pass->clearMask);
+    }
+
+    for (auto& read : pass->reads) {
+      if (read.second < 0 || resources[read.first].kind == IMPORTED_FRAMEBUFFER)
+        continue;
+      GLState::theOne().bindTexture(read.second, GL_TEXTURE_2D, resources[read.first].id);
+    }
+
+    pass->execute();
+    if (timed)
+      timer.end();
+  }
+}
+
+const FrameGraph::Stats& FrameGraph::getStats() const {
+  return stats;
+}
+
+void FrameGraph::setTimed(bool timed, int frameIndex) {
+  this->timed = timed;
+  this->frameIndex = frameIndex;
+}
+
+const vector<std::pair<std::string, double>>& FrameGraph::getPassTimes() const {
+  return timer.getResults();
+}
+
+int FrameGraph::getPassTimesFrame() const {
+  return timer.getResultFrame();
+}
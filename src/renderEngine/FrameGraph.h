@@ -0,0 +1,125 @@
+// FrameGraph.h
+#pragma once
+#include "GpuResources.h"
+#include "GpuTimer.h"
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// the passes of a frame declare the resources they read and write, and the
+// graph works out the rest: passes run in dependency order (grouped by
+// render target to save framebuffer and viewport switches), passes whose
+// output nobody uses are culled, transient textures with disjoint lifetimes
+// share storage, and framebuffers, viewports, clears and texture units are
+// set by the graph instead of by each pass.
+// Renderer rebuilds the graph every frame, pooled textures and framebuffers
+// persist across frames
+class FrameGraph {
+public:
+  typedef int Resource;
+  static const Resource INVALID = -1;
+
+  class Pass {
+    friend class FrameGraph;
+  private:
+    std::string name;
+    std::function<void()> execute;
+    std::vector<std::pair<Resource, int>> reads;
+    std::vector<Resource> colorWrites;
+    Resource depthWrite;
+    Resource framebufferWrite;
+    unsigned int clearMask;
+    bool sideEffect;
+    bool live;
+  public:
+    Pass(const char* name, std::function<void()> execute);
+
+    // unit < 0 declares the dependency without binding the texture
+    Pass& read(Resource resource, int unit = -1);
+    Pass& writeColor(Resource texture);
+    Pass& writeDepth(Resource texture);
+    // an imported framebuffer, written as a whole
+    Pass& write(Resource framebuffer);
+    Pass& clear(unsigned int mask);
+    // keeps the pass even though nothing reads what it writes
+    Pass& keep();
+  };
+
+  struct Stats {
+    int passes;
+    int culled;
+    int framebufferSwitches;
+    int viewportSwitches;
+    int transientTextures;
+    int physicalTextures;
+  };
+
+private:
+  enum Kind {
+    IMPORTED_TEXTURE,
+    IMPORTED_FRAMEBUFFER,
+    TRANSIENT_TEXTURE,
+  };
+
+  struct ResourceNode {
+    std::string name;
+    Kind kind;
+    unsigned int id;
+    int width, height;
+    unsigned int internalFormat;
+    int firstUse, lastUse;
+  };
+
+  struct PooledTexture {
+    int width, height;
+    unsigned int internalFormat;
+    GpuHandle texture;
+    int busyUntil;
+  };
+
+  std::vector<ResourceNode> resources;
+  std::deque<Pass> passes;
+  std::vector<Pass*> order;
+  std::vector<PooledTexture> texturePool;
+  std::map<std::vector<unsigned int>, GpuHandle> framebuffers;
+  Stats stats;
+  GpuTimer timer;
+  bool timed;
+  int frameIndex;
+
+  void sortPasses();
+  void cullPasses();
+  void allocateTransients();
+  unsigned int getFramebuffer(const Pass& pass);
+  bool getTargetSize(const Pass& pass, int& width, int& height) const;
+public:
+  FrameGraph();
+  ~FrameGraph();
+  // deletes the pooled textures and cached framebuffers
+  void clean();
+
+  // forgets the passes and resources of the last frame
+  void reset();
+
+  Resource importTexture(const char* name, unsigned int textureID, int width, int height);
+  Resource importFramebuffer(const char* name, unsigned int fboID, int width, int height);
+  // storage is taken from the pool when the graph is compiled
+  Resource createTexture(const char* name, int width, int height, unsigned int internalFormat);
+  unsigned int getTextureID(Resource texture) const;
+
+  Pass& addPass(const char* name, std::function<void()> execute);
+
+  void compile();
+  void execute();
+
+  const Stats& getStats() const;
+  // wraps every pass in a gpu timer query while set, the times are tagged
+  // with frameIndex
+  void setTimed(bool timed, int frameIndex);
+  // milliseconds per pass of the frame getPassTimesFrame(), a few frames old
+  const std::vector<std::pair<std::string, double>>& getPassTimes() const;
+  // -1 when no times landed this frame
+  int getPassTimesFrame() const;
+};
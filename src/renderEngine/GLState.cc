@@ -0,0 +1,138 @@
+// GLState.cc
+#include "GLState.h"
+#include "glPrerequisites.h"
+
+// tracked values start out unknown so the first call of each kind goes through
+static const int UNKNOWN = -1;
+
+GLState::GLState() {
+  const unsigned int caps[CAPABILITIES] = { GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, GL_MULTISAMPLE, GL_DEPTH_CLAMP };
+  for (int i = 0; i < CAPABILITIES; ++i)
+    capabilities[i].cap = caps[i];
+  current = last = Stats{ 0, 0 };
+  invalidate();
+}
+
+GLState& GLState::theOne() {
+  static GLState state;
+  return state;
+}
+
+void GLState::invalidate() {
+  for (int i = 0; i < CAPABILITIES; ++i)
+    capabilities[i].enabled = UNKNOWN;
+  cullFaceMode = UNKNOWN;
+  blendSource = blendDestination = UNKNOWN;
+  program = UNKNOWN;
+  vertexArray = UNKNOWN;
+  activeUnit = UNKNOWN;
+  for (int i = 0; i < TEXTURE_UNITS; ++i)
+    textures[i] = Binding{ 0, (unsigned int)UNKNOWN };
+  framebuffer = UNKNOWN;
+  viewportWidth = viewportHeight = UNKNOWN;
+}
+
+bool GLState::submit(bool changed) {
+  if (changed)
+    ++current.submitted;
+  else
+    ++current.filtered;
+  return changed;
+}
+
+void GLState::setCapability(unsigned int cap, bool enabled) {
+  for (int i = 0; i < CAPABILITIES; ++i) {
+    if (capabilities[i].cap != cap)
+      continue;
+    if (!submit(capabilities[i].enabled != (int)enabled))
+      return;
+    capabilities[i].enabled = enabled;
+    break;
+  }
+  if (enabled)
+    glEnable(cap);
+  else
+    glDisable(cap);
+}
+
+void GLState::enable(unsigned int cap) {
+  setCapability(cap, true);
+}
+
+void GLState::disable(unsigned int cap) {
+  setCapability(cap, false);
+}
+
+void GLState::cullFace(unsigned int mode) {
+  if (!submit(cullFaceMode != (int)mode))
+    return;
+  cullFaceMode = mode;
+  glCullFace(mode);
+}
+
+void GLState::blendFunc(unsigned int source, unsigned int destination) {
+  if (!submit(blendSource != (int)source || blendDestination != (int)destination))
+    return;
+  blendSource = source;
+  blendDestination = destination;
+  glBlendFunc(source, destination);
+}
+
+void GLState::useProgram(unsigned int programID) {
+  if (!submit(program != (int)programID))
+    return;
+  program = programID;
+  glUseProgram(programID);
+}
+
+void GLState::bindVertexArray(unsigned int vaoID) {
+  if (!submit(vertexArray != (int)vaoID))
+    return;
+  vertexArray = vaoID;
+  glBindVertexArray(vaoID);
+}
+
+void GLState::bindTexture(unsigned int unit, unsigned int target, unsigned int textureID) {
+  if (unit >= TEXTURE_UNITS) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(target, textureID);
+    activeUnit = unit;
+    ++current.submitted;
+    return;
+  }
+  Binding& binding = textures[unit];
+  if (!submit(binding.target != target || binding.textureID != textureID))
+    return;
+  if (activeUnit != (int)unit) {
+    activeUnit = unit;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    ++current.submitted;
+  }
+  binding.target = target;
+  binding.textureID = textureID;
+  glBindTexture(target, textureID);
+}
+
+void GLState::bindFramebuffer(unsigned int fboID) {
+  if (!submit(framebuffer != (int)fboID))
+    return;
+  framebuffer = fboID;
+  glBindFramebuffer(GL_FRAMEBUFFER, fboID);
+}
+
+void GLState::viewport(int width, int height) {
+  if (!submit(viewportWidth != width || viewportHeight != height))
+    return;
+  viewportWidth = width;
+  viewportHeight = height;
+  glViewport(0, 0, width, height);
+}
+
+void GLState::endFrame() {
+  last = current;
+  current = Stats{ 0, 0 };
+}
+
+const GLState::Stats& GLState::getFrameStats() const {
+  return last;
+}
@@ -0,0 +1,61 @@
+// GLState.h
+#pragma once
+#include "glPrerequisites.h"
+
+// shadows the pipeline state the renderer touches and only forwards calls
+// that change it. Anything that binds behind its back must call invalidate,
+// after which the next call of every kind is submitted
+class GLState {
+public:
+  struct Stats {
+    int submitted;
+    int filtered;
+  };
+
+private:
+  static const int CAPABILITIES = 5;
+  static const int TEXTURE_UNITS = 16;
+
+  struct Capability {
+    unsigned int cap;
+    int enabled;
+  };
+
+  struct Binding {
+    unsigned int target;
+    unsigned int textureID;
+  };
+
+  Capability capabilities[CAPABILITIES];
+  int cullFaceMode;
+  int blendSource, blendDestination;
+  int program;
+  int vertexArray;
+  int activeUnit;
+  Binding textures[TEXTURE_UNITS];
+  int framebuffer;
+  int viewportWidth, viewportHeight;
+  Stats current, last;
+
+  GLState();
+  bool submit(bool changed);
+  void setCapability(unsigned int cap, bool enabled);
+public:
+  static GLState& theOne();
+
+  void invalidate();
+  void enable(unsigned int cap);
+  void disable(unsigned int cap);
+  void cullFace(unsigned int mode);
+  void blendFunc(unsigned int source, unsigned int destination);
+  void useProgram(unsigned int programID);
+  void bindVertexArray(unsigned int vaoID);
+  void bindTexture(unsigned int unit, unsigned int target, unsigned int textureID);
+  void bindFramebuffer(unsigned int fboID);
+  void viewport(int width, int height);
+
+  // starts counting the next frame
+  void endFrame();
+  // counts of the last finished frame
+  const Stats& getFrameStats() const;
+};
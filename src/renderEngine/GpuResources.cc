@@ -0,0 +1,176 @@
+// GpuResources.cc
+#include "GpuResources.h"
+#include "glPrerequisites.h"
+#include "GLState.h"
+#include <iostream>
+using std::cout;
+
+GpuHandle::Object::~Object() {
+  GpuResources::theOne().release(*this);
+}
+
+unsigned int GpuHandle::getID() const {
+  return object ? object->id : 0;
+}
+
+long long GpuHandle::getBytes() const {
+  return object ? object->bytes : 0;
+}
+
+bool GpuHandle::isValid() const {
+  return object != nullptr;
+}
+
+void GpuHandle::reset() {
+  object.reset();
+}
+
+GpuResources::GpuResources(): frame(0), active(true) {
+  // releases report to both, so they are built first and destroyed after us
+  MemoryTracker::theOne();
+  GLState::theOne();
+  for (int type = 0; type < GPU_RESOURCE_TYPES; ++type)
+    stats.live[type] = 0;
+  stats.pooledBuffers = 0;
+  stats.pooledBytes = 0;
+  stats.reused = 0;
+  stats.created = 0;
+}
+
+GpuResources& GpuResources::theOne() {
+  static GpuResources resources;
+  return resources;
+}
+
+long long GpuResources::sizeClass(long long byteSize) {
+  long long power = MIN_SIZE_CLASS;
+  while (power < byteSize)
+    power <<= 1;
+  if (power == MIN_SIZE_CLASS)
+    return power;
+  long long step = power / 8;
+  return power / 2 + (byteSize - power / 2 + step - 1) / step * step;
+}
+
+GpuHandle GpuResources::wrap(unsigned int id, GpuResourceType type, long long bytes, MemoryTag tag, unsigned int usage) {
+  GpuHandle handle;
+  handle.object.reset(new GpuHandle::Object{ id, type, bytes, tag, usage });
+  ++stats.live[type];
+  return handle;
+}
+
+GpuHandle GpuResources::createVertexArray() {
+  unsigned int vaoID;
+  glGenVertexArrays(1, &vaoID);
+  return wrap(vaoID, GPU_VERTEX_ARRAY, 0, MEMORY_GPU_BUFFERS);
+}
+
+GpuHandle GpuResources::createBuffer(long long byteSize, unsigned int usage) {
+  long long bytes = sizeClass(byteSize);
+  auto it = freeBuffers.find(std::make_pair(bytes, usage));
+  if (it != freeBuffers.end() && !it->second.empty() && frame - it->second.front().releasedFrame >= LATENCY) {
+    // the oldest one, the gpu is most likely done with it
+    unsigned int vboID = it->second.front().id;
+    it->second.erase(it->second.begin());
+    --stats.pooledBuffers;
+    stats.pooledBytes -= bytes;
+    ++stats.reused;
+    return wrap(vboID, GPU_BUFFER, bytes, MEMORY_GPU_BUFFERS, usage);
+  }
+
+  unsigned int vboID;
+  glGenBuffers(1, &vboID);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, vboID);
+  glBufferData(GL_COPY_WRITE_BUFFER, bytes, NULL, usage);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  MemoryTracker::theOne().allocate(MEMORY_GPU_BUFFERS, bytes);
+  ++stats.created;
+  return wrap(vboID, GPU_BUFFER, bytes, MEMORY_GPU_BUFFERS, usage);
+}
+
+GpuHandle GpuResources::createTexture(long long bytes, MemoryTag tag) {
+  unsigned int textureID;
+  glGenTextures(1, &textureID);
+  MemoryTracker::theOne().allocate(tag, bytes);
+  return wrap(textureID, GPU_TEXTURE, bytes, tag);
+}
+
+GpuHandle GpuResources::createFramebuffer() {
+  unsigned int fboID;
+  glGenFramebuffers(1, &fboID);
+  return wrap(fboID, GPU_FRAMEBUFFER, 0, MEMORY_FRAMEBUFFERS);
+}
+
+void GpuResources::upload(const GpuHandle& buffer, const void* data, long long byteSize) {
+  glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.getID());
+  glBufferSubData(GL_COPY_WRITE_BUFFER, 0, byteSize, data);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void GpuResources::release(const GpuHandle::Object& object) {
+  --stats.live[object.type];
+  if (!active)
+    return;
+
+  if (object.type == GPU_BUFFER && stats.pooledBytes + object.bytes <= POOL_LIMIT) {
+    freeBuffers[std::make_pair(object.bytes, object.usage)].push_back({ object.id, frame });
+    ++stats.pooledBuffers;
+    stats.pooledBytes += object.bytes;
+    return;
+  }
+  deleteObject(object.type, object.id);
+  if (object.bytes)
+    MemoryTracker::theOne().release(object.tag, object.bytes);
+}
+
+void GpuResources::deleteObject(GpuResourceType type, unsigned int id) {
+  switch (type) {
+    case GPU_VERTEX_ARRAY:
+      glDeleteVertexArrays(1, &id);
+      break;
+    case GPU_BUFFER:
+      glDeleteBuffers(1, &id);
+      break;
+    case GPU_TEXTURE:
+      glDeleteTextures(1, &id);
+      break;
+    case GPU_FRAMEBUFFER:
+      glDeleteFramebuffers(1, &id);
+      break;
+    default:
+      break;
+  }
+  // the name may come back for a new object the cache thinks is bound
+  GLState::theOne().invalidate();
+}
+
+void GpuResources::endFrame() {
+  ++frame;
+}
+
+void GpuResources::clean() {
+  for (auto& entry : freeBuffers) {
+    for (FreeBuffer& buffer : entry.second) {
+      glDeleteBuffers(1, &buffer.id);
+      MemoryTracker::theOne().release(MEMORY_GPU_BUFFERS, entry.first.first);
+    }
+  }
+  freeBuffers.clear();
+  stats.pooledBuffers = 0;
+  stats.pooledBytes = 0;
+  GLState::theOne().invalidate();
+
+  int leaked = 0;
+  for (int type = 0; type < GPU_RESOURCE_TYPES; ++type)
+    leaked += stats.live[type];
+  if (leaked) {
+    cout << "==================================================\n";
+    cout << "WARNING::GPU: " << leaked << " objects are still referenced when the context goes away";
+    cout << "\n==================================================\n";
+  }
+  active = false;
+}
+
+const GpuResources::Stats& GpuResources::getStats() const {
+  return stats;
+}
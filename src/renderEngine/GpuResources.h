@@ -0,0 +1,104 @@
+// GpuResources.h
+#pragma once
+#include <utils/MemoryTracker.h>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+enum GpuResourceType {
+  GPU_VERTEX_ARRAY,
+  GPU_BUFFER,
+  GPU_TEXTURE,
+  GPU_FRAMEBUFFER,
+  GPU_RESOURCE_TYPES,
+};
+
+// shared ownership of one GL object. Copies share the object and the last
+// one to go hands it back to GpuResources; a default handle owns nothing
+class GpuHandle {
+  friend class GpuResources;
+private:
+  struct Object {
+    unsigned int id;
+    GpuResourceType type;
+    // storage accounted under tag, for buffers the size class
+    long long bytes;
+    MemoryTag tag;
+    unsigned int usage;
+    ~Object();
+  };
+  std::shared_ptr<Object> object;
+public:
+  unsigned int getID() const;
+  long long getBytes() const;
+  bool isValid() const;
+  // gives up this reference, the object is released with the last one
+  void reset();
+};
+
+// creates the GL objects behind GpuHandles and frees them deterministically
+// when their last handle goes. Released buffers are not deleted but kept
+// per size class and usage, and handed out again once the frames that may
+// still read them are done, so sessions that keep creating and dropping
+// buffers stay at a flat footprint
+class GpuResources {
+  friend class GpuHandle;
+public:
+  // frames a released buffer waits before it is reused
+  static const int LATENCY = 3;
+  static const long long MIN_SIZE_CLASS = 256;
+  // pooled bytes above this are deleted instead of kept
+  static const long long POOL_LIMIT = 32ll << 20;
+
+  struct Stats {
+    int live[GPU_RESOURCE_TYPES];
+    int pooledBuffers;
+    long long pooledBytes;
+    // buffers handed out from the pool and newly created ones, since start
+    int reused;
+    int created;
+  };
+
+private:
+  struct FreeBuffer {
+    unsigned int id;
+    int releasedFrame;
+  };
+
+  // by size class and usage, most recently released last
+  std::map<std::pair<long long, unsigned int>, std::vector<FreeBuffer>> freeBuffers;
+  Stats stats;
+  int frame;
+  // false once clean() ran, later releases have no context to go to
+  bool active;
+
+  GpuResources();
+  GpuHandle wrap(unsigned int id, GpuResourceType type, long long bytes, MemoryTag tag, unsigned int usage = 0);
+  void release(const GpuHandle::Object& object);
+  void deleteObject(GpuResourceType type, unsigned int id);
+public:
+  static GpuResources& theOne();
+
+  // byteSize rounded up to a quarter step between powers of two, so at
+  // most a fifth of a buffer is wasted
+  static long long sizeClass(long long byteSize);
+
+  GpuHandle createVertexArray();
+  // at least byteSize bytes of storage, taken from the pool when a buffer
+  // of the same class and usage is free; the contents are undefined
+  GpuHandle createBuffer(long long byteSize, unsigned int usage);
+  // the caller allocates the storage, bytes is only for accounting
+  GpuHandle createTexture(long long bytes, MemoryTag tag);
+  GpuHandle createFramebuffer();
+
+  // writes data to the start of a buffer, without touching the bindings of
+  // the current vao
+  static void upload(const GpuHandle& buffer, const void* data, long long byteSize);
+
+  void endFrame();
+  // deletes the pooled buffers, needs the context; handles released
+  // afterwards are only reported
+  void clean();
+  const Stats& getStats() const;
+};
@@ -0,0 +1,78 @@
+// GpuTimer.cc
+#include "GpuTimer.h"
+#include "glPrerequisites.h"
+using std::vector;
+
+GpuTimer::GpuTimer(): resultFrame(-1), current(0), running(false) {
+  for (int i = 0; i < LATENCY; ++i)
+    frameIndices[i] = -1;
+}
+
+GpuTimer::~GpuTimer() {
+  clean();
+}
+
+void GpuTimer::clean() {
+  for (int i = 0; i < LATENCY; ++i) {
+    for (Query& query : frames[i])
+      freeQueries.push_back(query.queryID);
+    frames[i].clear();
+  }
+  if (!freeQueries.empty())
+    glDeleteQueries(freeQueries.size(), &freeQueries.front());
+  freeQueries.clear();
+  results.clear();
+  resultFrame = -1;
+}
+
+void GpuTimer::beginFrame(int frameIndex) {
+  current = (current + 1) % LATENCY;
+  vector<Query>& frame = frames[current];
+  results.clear();
+  resultFrame = -1;
+  if (!frame.empty()) {
+    // queries finish in order, so the last one tells whether the frame is done
+    int available = 0;
+    glGetQueryObjectiv(frame.back().queryID, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available) {
+      resultFrame = frameIndices[current];
+      for (Query& query : frame) {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(query.queryID, GL_QUERY_RESULT, &elapsed);
+        results.push_back(std::make_pair(query.name, elapsed / 1000000.0));
+      }
+    }
+    for (Query& query : frame)
+      freeQueries.push_back(query.queryID);
+    frame.clear();
+  }
+  frameIndices[current] = frameIndex;
+}
+
+void GpuTimer::begin(const std::string& name) {
+  unsigned int queryID;
+  if (freeQueries.empty()) {
+    glGenQueries(1, &queryID);
+  } else {
+    queryID = freeQueries.back();
+    freeQueries.pop_back();
+  }
+  frames[current].push_back({ name, queryID });
+  glBeginQuery(GL_TIME_ELAPSED, queryID);
+  running = true;
+}
+
+void GpuTimer::end() {
+  if (!running)
+    return;
+  glEndQuery(GL_TIME_ELAPSED);
+  running = false;
+}
+
+const vector<std::pair<std::string, double>>& GpuTimer::getResults() const {
+  return results;
+}
+
+int GpuTimer::getResultFrame() const {
+  return resultFrame;
+}
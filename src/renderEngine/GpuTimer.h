@@ -0,0 +1,42 @@
+// GpuTimer.h
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+// times sections of a frame with GL_TIME_ELAPSED queries. Results are read
+// LATENCY frames later so the cpu never waits for them, tagged with the
+// index of the frame they were recorded in; a frame whose queries have not
+// landed by then is dropped
+class GpuTimer {
+private:
+  static const int LATENCY = 3;
+
+  struct Query {
+    std::string name;
+    unsigned int queryID;
+  };
+
+  std::vector<Query> frames[LATENCY];
+  int frameIndices[LATENCY];
+  std::vector<unsigned int> freeQueries;
+  std::vector<std::pair<std::string, double>> results;
+  int resultFrame;
+  int current;
+  bool running;
+public:
+  GpuTimer();
+  ~GpuTimer();
+  void clean();
+
+  // collects the oldest frame in flight and starts recording frameIndex
+  void beginFrame(int frameIndex);
+  void begin(const std::string& name);
+  void end();
+
+  // milliseconds per section of the frame collected by the last beginFrame,
+  // empty when none landed
+  const std::vector<std::pair<std::string, double>>& getResults() const;
+  // index the results were recorded in, -1 when they are empty
+  int getResultFrame() const;
+};
@@ -0,0 +1,274 @@
+// HeadlessDisplay.cc
+#include "HeadlessDisplay.h"
+#include "glPrerequisites.h"
+#include "GLState.h"
+#include <utils/MemoryTracker.h>
+#include <common.h>
+#ifdef __linux__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+using std::cout;
+using std::vector;
+
+unsigned int HeadlessDisplay::fboID = 0;
+unsigned int HeadlessDisplay::colorBuffer = 0;
+unsigned int HeadlessDisplay::depthBuffer = 0;
+int HeadlessDisplay::frames = 0;
+long double HeadlessDisplay::startTime = 0;
+int HeadlessDisplay::exitCode = 0;
+bool HeadlessDisplay::closed = false;
+
+#ifdef __linux__
+static EGLDisplay display = EGL_NO_DISPLAY;
+static EGLContext context = EGL_NO_CONTEXT;
+
+static void* loadProc(const char* name) {
+  return (void*)eglGetProcAddress(name);
+}
+
+static void printError(const char* message) {
+  cout << "==================================================\n";
+  cout << "ERROR::HEADLESS: " << message << " (EGL error 0x" << std::hex << eglGetError() << std::dec << ")";
+  cout << "\n==================================================\n";
+}
+
+static bool createContext() {
+  // prefer mesa's surfaceless platform, it needs neither a display server nor a drm device
+  PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+    (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+  if (getPlatformDisplay)
+    display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+  if (display == EGL_NO_DISPLAY)
+    display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+    printError("Failed to initialize an EGL display");
+    return false;
+  }
+
+  const EGLint configAttributes[] = {
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+    EGL_NONE
+  };
+  EGLConfig config;
+  EGLint configCount = 0;
+  if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+    printError("No EGL config supports desktop OpenGL");
+    return false;
+  }
+
+  const EGLint contextAttributes[] = {
+    EGL_CONTEXT_MAJOR_VERSION, 3,
+    EGL_CONTEXT_MINOR_VERSION, 3,
+    EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+    EGL_NONE
+  };
+  context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+  if (context == EGL_NO_CONTEXT) {
+    printError("Failed to create an OpenGL 3.3 core context");
+    return false;
+  }
+  // EGL_KHR_surfaceless_context, all rendering goes to our framebuffer object
+  if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+    printError("Failed to make the surfaceless context current");
+    return false;
+  }
+  return true;
+}
+
+static void destroyContext() {
+  if (display == EGL_NO_DISPLAY)
+    return;
+  eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  if (context != EGL_NO_CONTEXT)
+    eglDestroyContext(display, context);
+  eglTerminate(display);
+  context = EGL_NO_CONTEXT;
+  display = EGL_NO_DISPLAY;
+}
+#else
+static void* loadProc(const char* name) {
+  return nullptr;
+}
+
+static bool createContext() {
+  cout << "==================================================\n";
+  cout << "ERROR::HEADLESS: Headless rendering needs EGL, which is only used on Linux";
+  cout << "\n==================================================\n";
+  return false;
+}
+
+static void destroyContext() {}
+#endif
+
+static long long renderbufferBytes() {
+  return MemoryTracker::textureBytes(GL_RGBA8, ACTUAL_WIDTH, ACTUAL_HEIGHT) +
+         MemoryTracker::textureBytes(GL_DEPTH_COMPONENT24, ACTUAL_WIDTH, ACTUAL_HEIGHT);
+}
+
+// binary ppm, rows from top to bottom
+static bool writePPM(const char* fileName, int width, int height, const vector<uint8_t>& rgb) {
+  std::ofstream file(fileName, std::ios::binary);
+  if (!file.is_open())
+    return false;
+  file << "P6\n" << width << " " << height << "\n255\n";
+  file.write((const char*)&rgb.front(), rgb.size());
+  return file.good();
+}
+
+static bool readPPM(const char* fileName, int& width, int& height, vector<uint8_t>& rgb) {
+  std::ifstream file(fileName, std::ios::binary);
+  std::string magic;
+  int maxValue;
+  if (!(file >> magic >> width >> height >> maxValue) || magic != "P6" || maxValue != 255)
+    return false;
+  file.get();
+  rgb.resize(width * height * 3);
+  file.read((char*)&rgb.front(), rgb.size());
+  return file.gcount() == (std::streamsize)rgb.size();
+}
+
+bool HeadlessDisplay::createDisplay() {
+  WIDTH = ACTUAL_WIDTH = HEADLESS::WIDTH;
+  HEIGHT = ACTUAL_HEIGHT = HEADLESS::HEIGHT;
+
+  if (!createContext() || gladLoadGLLoader((GLADloadproc)loadProc) == 0) {
+    exitCode = 1;
+    return false;
+  }
+
+  glGenRenderbuffers(1, &colorBuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, ACTUAL_WIDTH, ACTUAL_HEIGHT);
+  glGenRenderbuffers(1, &depthBuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, ACTUAL_WIDTH, ACTUAL_HEIGHT);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+  MemoryTracker::theOne().allocate(MEMORY_FRAMEBUFFERS, renderbufferBytes());
+
+  glGenFramebuffers(1, &fboID);
+  glBindFramebuffer(GL_FRAMEBUFFER, fboID);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    cout << "==================================================\n";
+    cout << "ERROR::HEADLESS: Offscreen framebuffer is incomplete";
+    cout << "\n==================================================\n";
+    exitCode = 1;
+    return false;
+  }
+
+  startTime = getTime();
+  return true;
+}
+
+void HeadlessDisplay::updateDisplay() {
+  if (++frames == HEADLESS::FRAMES)
+    finish();
+}
+
+void HeadlessDisplay::closeDisplay() {
+  if (!closed && frames < HEADLESS::FRAMES)
+    finish();
+}
+
+void HeadlessDisplay::finish() {
+  closed = true;
+  glFinish();
+  long double seconds = getTime() - startTime;
+  cout << "HEADLESS: " << frames << " frames at " << ACTUAL_WIDTH << "x" << ACTUAL_HEIGHT << " in " << (double)seconds
+       << "s, " << (double)(seconds > 0 ? frames / seconds : 0) << " fps\n";
+
+  // gl rows start at the bottom, ppm rows at the top
+  vector<uint8_t> rgba(ACTUAL_WIDTH * ACTUAL_HEIGHT * 4);
+  GLState::theOne().bindFramebuffer(fboID);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, ACTUAL_WIDTH, ACTUAL_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, &rgba.front());
+  vector<uint8_t> rgb(ACTUAL_WIDTH * ACTUAL_HEIGHT * 3);
+  for (int y = 0; y < ACTUAL_HEIGHT; ++y) {
+    const uint8_t* src = &rgba[(ACTUAL_HEIGHT - 1 - y) * ACTUAL_WIDTH * 4];
+    uint8_t* dst = &rgb[y * ACTUAL_WIDTH * 3];
+    for (int x = 0; x < ACTUAL_WIDTH; ++x) {
+      dst[x * 3] = src[x * 4];
+      dst[x * 3 + 1] = src[x * 4 + 1];
+      dst[x * 3 + 2] = src[x * 4 + 2];
+    }
+  }
+
+  if (HEADLESS::OUTPUT && !writePPM(HEADLESS::OUTPUT, ACTUAL_WIDTH, ACTUAL_HEIGHT, rgb)) {
+    cout << "==================================================\n";
+    cout << "ERROR::HEADLESS: Failed to write " << HEADLESS::OUTPUT;
+    cout << "\n==================================================\n";
+  }
+
+  if (!HEADLESS::GOLDEN)
+    return;
+
+  int width, height;
+  vector<uint8_t> golden;
+  if (!readPPM(HEADLESS::GOLDEN, width, height, golden) || width != ACTUAL_WIDTH || height != ACTUAL_HEIGHT) {
+    cout << "==================================================\n";
+    cout << "ERROR::HEADLESS: " << HEADLESS::GOLDEN << " is not a " << ACTUAL_WIDTH << "x" << ACTUAL_HEIGHT << " binary ppm";
+    cout << "\n==================================================\n";
+    exitCode = 1;
+    return;
+  }
+
+  // rasterizers may differ slightly along edges, so only pixels off by more
+  // than the tolerance count
+  int mismatched = 0, maxDifference = 0;
+  for (int i = 0; i < ACTUAL_WIDTH * ACTUAL_HEIGHT; ++i) {
+    int difference = 0;
+    for (int c = 0; c < 3; ++c)
+      difference = std::max(difference, std::abs(rgb[i * 3 + c] - golden[i * 3 + c]));
+    maxDifference = std::max(maxDifference, difference);
+    if (difference > HEADLESS::TOLERANCE)
+      ++mismatched;
+  }
+  float fraction = (float)mismatched / (ACTUAL_WIDTH * ACTUAL_HEIGHT);
+  bool passed = fraction * 100.0f <= HEADLESS::MAX_MISMATCH_PERCENT;
+  cout << "HEADLESS: golden " << (passed ? "passed" : "FAILED") << ", " << mismatched << " pixels ("
+       << fraction * 100.0f << "%) differ by more than " << HEADLESS::TOLERANCE << ", max difference " << maxDifference << "\n";
+  if (!passed)
+    exitCode = 2;
+}
+
+void HeadlessDisplay::cleanDisplay() {
+  if (fboID) {
+    glDeleteFramebuffers(1, &fboID);
+    glDeleteRenderbuffers(1, &colorBuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+    MemoryTracker::theOne().release(MEMORY_FRAMEBUFFERS, renderbufferBytes());
+    fboID = colorBuffer = depthBuffer = 0;
+  }
+  destroyContext();
+}
+
+bool HeadlessDisplay::shouldCloseDisplay() {
+  return exitCode != 0 || closed;
+}
+
+unsigned int HeadlessDisplay::getFramebuffer() {
+  return fboID;
+}
+
+void* HeadlessDisplay::getProcAddress(const char* name) {
+  return loadProc(name);
+}
+
+long double HeadlessDisplay::getTime() {
+  static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  return std::chrono::duration<long double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int HeadlessDisplay::getExitCode() {
+  return exitCode;
+}
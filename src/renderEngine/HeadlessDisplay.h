@@ -0,0 +1,32 @@
+// HeadlessDisplay.h
+#pragma once
+
+// renders into a framebuffer object of a surfaceless EGL context, so the
+// game runs on machines without a display or gpu (e.g. mesa's llvmpipe).
+// After HEADLESS::FRAMES frames the image is written to HEADLESS::OUTPUT and
+// compared against HEADLESS::GOLDEN when one is given
+class HeadlessDisplay {
+private:
+  static unsigned int fboID;
+  static unsigned int colorBuffer;
+  static unsigned int depthBuffer;
+  static int frames;
+  static long double startTime;
+  static int exitCode;
+  static bool closed;
+
+  static void finish();
+public:
+  static bool createDisplay();
+  static void updateDisplay();
+  static void cleanDisplay();
+  // ends the run early, e.g. when a stress test finishes, the last frame is still captured
+  static void closeDisplay();
+  static bool shouldCloseDisplay();
+
+  static unsigned int getFramebuffer();
+  static void* getProcAddress(const char* name);
+  static long double getTime();
+  // non zero when the context could not be created or the golden image differs
+  static int getExitCode();
+};
@@ -1,49 +1,104 @@
 // Renderer.cc
 #include "Renderer.h"
 #include "glPrerequisites.h"
-#include <GLFW/glfw3.h>
 #include <common.h>
 #include <entities/Entity.h>
+#include <entities/gameObjects/Camera.h>
+#include <gameEngine/FrameStats.h>
+#include <renderEngine/DisplayManager.h>
+#include <renderEngine/GLState.h>
+#include <algorithm>
 #include <iostream>
 
 using std::cout;
 
-Renderer::Renderer() : seaShadowShader(true) {
+Renderer::Renderer() : particleShadowShader(true), frame(0) {
+  entityShader.compileVariants();
+  shadowShader.compileVariants();
   ShadowShader::init();
-  // depth
-  glGenRenderbuffers(1, &depthBuffer);
-  glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
-  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32, ACTUAL_WIDTH,
-                        ACTUAL_HEIGHT);
-  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
-                            GL_RENDERBUFFER, depthBuffer);
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-  assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+}
+
+void Renderer::init() {
+  ParticleShader::init();
+  seaShader.init();
 }
 
 Renderer::~Renderer() {}
 
+void Renderer::addShadowPasses(FrameGraph::Resource staticShadow, FrameGraph::Resource dynamicShadow) {
+  bool updateStatic = frame % std::max(SHADOW::STATIC_INTERVAL, 1) == 0;
+  bool updateDynamic = frame % std::max(SHADOW::DYNAMIC_INTERVAL, 1) == 0;
+  ++frame;
+
+  // both layers must be rendered with the matrix the receivers sample with.
+  // It is only refitted when the static layer is due, the dynamic layer
+  // follows then, in between the dynamic layer reuses the static projection
+  if (updateStatic) {
+    Camera::primary().updateLightSpaceMatrix();
+    updateDynamic = true;
+  }
+  FrameStats::theOne().addShadowLayers(updateStatic, updateDynamic);
+
+  // a layer that is not redrawn keeps its contents from an earlier frame.
+  // Casters between the light and the shadow box are clamped onto its near
+  // plane instead of being clipped, so they still shadow what is inside
+  if (updateStatic) {
+    graph.addPass("static shadow", [this]() {
+      GLState::theOne().cullFace(GL_FRONT);
+      GLState::theOne().enable(GL_DEPTH_CLAMP);
+      shadowShader.render(SHADOW_STATIC);
+      GLState::theOne().disable(GL_DEPTH_CLAMP);
+      GLState::theOne().cullFace(GL_BACK);
+    }).writeDepth(staticShadow).clear(GL_DEPTH_BUFFER_BIT);
+  }
+  if (updateDynamic) {
+    graph.addPass("dynamic shadow", [this]() {
+      GLState::theOne().cullFace(GL_FRONT);
+      GLState::theOne().enable(GL_DEPTH_CLAMP);
+      shadowShader.render(SHADOW_DYNAMIC);
+      particleShadowShader.render();
+      GLState::theOne().disable(GL_DEPTH_CLAMP);
+      GLState::theOne().cullFace(GL_BACK);
+    }).writeDepth(dynamicShadow).clear(GL_DEPTH_BUFFER_BIT);
+  }
+}
+
 void Renderer::render() {
-  // render to depth map
-  glViewport(0, 0, SHADOW::WIDTH, SHADOW::HEIGHT); // temporary
-  glBindFramebuffer(GL_FRAMEBUFFER, ShadowShader::getFboID());
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  glCullFace(GL_FRONT);
-  seaShadowShader.render();
-  entityShadowShader.render();
-  glCullFace(GL_BACK);
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-  glViewport(0, 0, ACTUAL_WIDTH, ACTUAL_HEIGHT);
-  // render the actual scene to image
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, ShadowShader::getDepthMap().getID());
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  backgroundShader.render();
-  entityShader.render();
-  seaShader.render();
-
-  // render ui
-  uiShader.render();
+  ParticleShader::upload();
+
+  graph.reset();
+  FrameGraph::Resource backbuffer =
+    graph.importFramebuffer("backbuffer", DisplayManager::getFramebuffer(), ACTUAL_WIDTH, ACTUAL_HEIGHT);
+  FrameGraph::Resource staticShadow = graph.importTexture("static shadow map",
+    ShadowShader::getDepthMap(SHADOW_STATIC).getID(), SHADOW::WIDTH, SHADOW::HEIGHT);
+  FrameGraph::Resource dynamicShadow = graph.importTexture("dynamic shadow map",
+    ShadowShader::getDepthMap(SHADOW_DYNAMIC).getID(), SHADOW::WIDTH, SHADOW::HEIGHT);
+
+  addShadowPasses(staticShadow, dynamicShadow);
+
+  // the shaders expect the static layer on unit 0 and the dynamic layer on unit 1
+  graph.addPass("background", [this]() { backgroundShader.render(); })
+    .write(backbuffer).clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  graph.addPass("entities", [this]() { entityShader.render(); })
+    .read(staticShadow, 0).read(dynamicShadow, 1).write(backbuffer);
+  graph.addPass("particles", [this]() { particleShader.render(); })
+    .write(backbuffer);
+  graph.addPass("sea", [this]() { seaShader.render(); })
+    .read(staticShadow, 0).read(dynamicShadow, 1).write(backbuffer);
+  graph.addPass("ui", [this]() { uiShader.render(); })
+    .write(backbuffer);
+  graph.addPass("capture", [this]() { capture.capture(); })
+    .read(backbuffer).keep();
+
+  FrameStats& stats = FrameStats::theOne();
+  graph.setTimed(stats.isActive(), stats.getFrame());
+  graph.compile();
+  graph.execute();
+  stats.setPassTimes(graph.getPassTimes(), graph.getPassTimesFrame());
+}
+
+void Renderer::clean() {
+  capture.finish();
+  graph.clean();
+  ShadowShader::cleanLayers();
 }
@@ -2,9 +2,12 @@
 #pragma once
 #include <shaders/BackgroundShader.h>
 #include <shaders/EntityShader.h>
+#include <shaders/ParticleShader.h>
 #include <shaders/SeaShader.h>
 #include <shaders/ShadowShader.h>
 #include <shaders/UIShader.h>
+#include <renderEngine/FrameCapture.h>
+#include <renderEngine/FrameGraph.h>
 
 class Renderer {
 private:
@@ -12,14 +15,26 @@ private:
   UIShader uiShader;
   EntityShader entityShader;
   SeaShader seaShader;
-  ShadowShader seaShadowShader;
-  ShadowShader entityShadowShader;
+  ShadowShader shadowShader;
+  ParticleShader particleShader;
+  ParticleShader particleShadowShader;
 
-  unsigned int depthBuffer;
+  FrameCapture capture;
+  FrameGraph graph;
+
+  unsigned int frame;
+
+  // adds the passes of the shadow layers that are due this frame
+  void addShadowPasses(FrameGraph::Resource staticShadow, FrameGraph::Resource dynamicShadow);
 
 public:
+  // compiles every program, which needs the context but no geometry
   Renderer();
   ~Renderer();
+  // sets up what draws the uploaded geometry
+  void init();
 
   void render();
+  // releases what needs the context before the display goes away
+  void clean();
 };
@@ -2,8 +2,10 @@
 #include "BackgroundShader.h"
 #include "ShaderProgram.h"
 #include <common.h>
+#include <gameEngine/FrameStats.h>
 #include <models/RawModel.h>
 #include <models/Loader.h>
+#include <renderEngine/GLState.h>
 #include "glPrerequisites.h"
 #include <vector>
 using std::vector;
@@ -66,10 +68,9 @@ void BackgroundShader::getAllUniformLocations() { }
 
 void BackgroundShader::render() {
   start();
-  glEnable(GL_CULL_FACE);
-  glDisable(GL_DEPTH_TEST);
+  GLState::theOne().enable(GL_CULL_FACE);
+  GLState::theOne().disable(GL_DEPTH_TEST);
   background->bind();
   glDrawArrays(GL_TRIANGLES, 0, background->getVertexCount());
-  RawModel::unbind();
-  stop();
+  FrameStats::theOne().addDraw(background->getVertexCount() / 3);
 }
@@ -1,26 +1,41 @@
 // EntityShader.cc
 #include "EntityShader.h"
+#include "ShadowShader.h"
 #include "glPrerequisites.h"
 #include <common.h>
 #include <entities/DynamicEntity.h>
 #include <entities/Entity.h>
 #include <entities/gameObjects/Camera.h>
 #include <entities/gameObjects/Light.h>
-#include <entities/gameObjects/ParticleHolder.h>
+#include <gameEngine/FrameStats.h>
+#include <gameEngine/World.h>
+#include <renderEngine/GLState.h>
 #include <iostream>
 
 using std::cout;
 using std::vector;
 
-EntityShader::EntityShader() {
+EntityShader::EntityShader(unsigned int variantKey) : ShaderProgram(variantKey) {
   const char *VERTEX_FILE = "../shaders/entity.vert";
   const char *FRAGMENT_FILE = "../shaders/entity.frag";
-  ShaderProgram::init(VERTEX_FILE, FRAGMENT_FILE);
+  ShaderProgram::init(VERTEX_FILE, FRAGMENT_FILE, nullptr, EntityShader::variantDefines(variantKey));
+}
+
+std::string EntityShader::variantDefines(unsigned int key) const {
+  std::string defines = fogDefines(FOG::END);
+  if (key & RECEIVE_SHADOW)
+    defines += "#define RECEIVE_SHADOW\n" + ShadowShader::receiverDefines();
+  return defines;
+}
+
+ShaderProgram* EntityShader::createVariant(unsigned int key) const {
+  return new EntityShader(key);
 }
 
 void EntityShader::bindAttributes() {
   bindAttribute(0, "position");
   bindAttribute(1, "normal");
+  bindAttribute(2, "vertexColor");
 }
 
 void EntityShader::getAllUniformLocations() {
@@ -30,73 +45,73 @@ void EntityShader::getAllUniformLocations() {
   location_color = getUniformLocation("color");
   location_light = getUniformLocation("lightPos");
   location_shadowMap = getUniformLocation("shadowMap");
+  location_dynamicShadowMap = getUniformLocation("dynamicShadowMap");
   location_opacity = getUniformLocation("opacity");
-  location_receiveShadow = getUniformLocation("receiveShadow");
   location_prevPVM = getUniformLocation("prevPVM");
 }
 
 void EntityShader::render() {
+  // receivers and non receivers are drawn by separate programs, so no
+  // fragment branches on the shadow flag
+  static_cast<EntityShader&>(variant(RECEIVE_SHADOW)).renderVariant();
+  static_cast<EntityShader&>(variant(0)).renderVariant();
+}
+
+void EntityShader::compileVariants() {
+  variant(RECEIVE_SHADOW);
+  variant(0);
+}
+
+void EntityShader::renderVariant() {
+  bool started = false;
+  renderEntities(World::current().staticEntities, started);
+  renderEntities(World::current().dynamicEntities, started);
+}
+
+void EntityShader::begin() {
   start();
-  glEnable(GL_DEPTH_TEST);
-  glEnable(GL_BLEND);
-  glEnable(GL_CULL_FACE);
+  GLState::theOne().enable(GL_DEPTH_TEST);
+  GLState::theOne().enable(GL_BLEND);
+  GLState::theOne().enable(GL_CULL_FACE);
   glm::vec3 lightPos(Light::theOne().getPosition());
   loadInt(location_shadowMap, 0);
-  loadFloat(location_ambientLightIntensity, AMBIENT_LIGHT_INTENSITY);
+  loadInt(location_dynamicShadowMap, 1);
+  loadFloat(location_ambientLightIntensity, World::current().ambientLightIntensity);
   loadVector3f(location_light, lightPos);
   loadMatrix4f(location_lightSpaceMatrix,
                Camera::primary().getLightSpaceMatrix());
   loadMatrix4f(location_viewMatrix, Camera::primary().getViewMatrix());
   loadMatrix4f(location_projectionMatrix,
                Camera::primary().getProjectionMatrix());
-  glm::mat4 PV = Camera::primary().getPVMatrix();
-  for (auto &entry : staticEntities) {
-    vector<Entity *> &entities = entry.second;
-    entry.first->bind();
-    for (int i = 0; i < entities.size(); ++i) {
-      Entity *entity = entities.at(i);
-      RawModel *model = entity->getModel();
-      loadBool(location_receiveShadow, entity->getReceiveShadow());
-      loadFloat(location_opacity, entity->getOpacity());
-      loadVector3f(location_color, entity->getColor());
-      loadMatrix4f(location_transformationMatrix,
-                   entity->getTransformationMatrix());
+  // models without a color stream are tinted by the uniform color only
+  glVertexAttrib4f(2, 1.0f, 1.0f, 1.0f, 1.0f);
+}
 
-      glDrawArrays(GL_TRIANGLES, 0, model->getVertexCount());
-    }
-    RawModel::unbind();
-  }
-  for (auto &entry : dynamicEntities) {
-    vector<DynamicEntity *> &entities = entry.second;
-    entry.first->bind();
-    for (int i = 0; i < entities.size(); ++i) {
-      DynamicEntity *entity = entities.at(i);
+template <typename ENTITIES>
+void EntityShader::renderEntities(ENTITIES &entities, bool &started) {
+  bool receiveShadow = variantKey & RECEIVE_SHADOW;
+  for (auto &entry : entities) {
+    bool bound = false;
+    for (auto *entity : entry.second) {
+      if (entity->getReceiveShadow() != receiveShadow)
+        continue;
+      if (!started) {
+        begin();
+        started = true;
+      }
+      if (!bound) {
+        entry.first->bind();
+        bound = true;
+      }
       RawModel *model = entity->getModel();
-      loadBool(location_receiveShadow, entity->getReceiveShadow());
       loadFloat(location_opacity, entity->getOpacity());
       loadVector3f(location_color, entity->getColor());
       loadMatrix4f(location_transformationMatrix,
                    entity->getTransformationMatrix());
 
-      glDrawArrays(GL_TRIANGLES, 0, model->getVertexCount());
+      const LodLevel& lod = model->getLod(entity->selectLod());
+      glDrawArrays(GL_TRIANGLES, lod.first, lod.count);
+      FrameStats::theOne().addDraw(lod.count / 3);
     }
-    RawModel::unbind();
-  }
-
-  vector<DynamicEntity *> &particles = ParticleHolder::getParticles();
-  if (particles.size())
-    particles[0]->getModel()->bind();
-  for (int i = 0; i < particles.size(); ++i) {
-    DynamicEntity *particle = particles.at(i);
-    RawModel *model = particle->getModel();
-    loadBool(location_receiveShadow, particle->getReceiveShadow());
-    loadFloat(location_opacity, particle->getOpacity());
-    loadVector3f(location_color, particle->getColor());
-    loadMatrix4f(location_transformationMatrix,
-                 particle->getTransformationMatrix());
-
-    glDrawArrays(GL_TRIANGLES, 0, model->getVertexCount());
   }
-  RawModel::unbind();
-  stop();
 }
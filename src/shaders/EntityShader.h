@@ -9,14 +9,29 @@ protected:
   int location_color;
   int location_light;
   int location_shadowMap;
+  int location_dynamicShadowMap;
   int location_opacity;
-  int location_receiveShadow;
   int location_prevPVM;
   void bindAttributes();
   void getAllUniformLocations();
+  std::string variantDefines(unsigned int key) const;
+  ShaderProgram* createVariant(unsigned int key) const;
+
+  // draws the entities whose shadow flag matches this variant, the program
+  // is only bound once one of them is found
+  void renderVariant();
+  void begin();
+  template <typename ENTITIES>
+  void renderEntities(ENTITIES& entities, bool& started);
 
 public:
-  EntityShader();
+  enum Variant {
+    RECEIVE_SHADOW = 1 << 0,
+  };
+
+  EntityShader(unsigned int variantKey = RECEIVE_SHADOW);
 
   void render();
+  // compiles the variants render() uses ahead of the first frame
+  void compileVariants();
 };
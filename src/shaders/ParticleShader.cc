@@ -0,0 +1,155 @@
+// ParticleShader.cc
+#include "ParticleShader.h"
+#include "glPrerequisites.h"
+#include <common.h>
+#include <entities/gameObjects/Camera.h>
+#include <entities/gameObjects/Light.h>
+#include <entities/gameObjects/ParticleHolder.h>
+#include <gameEngine/FrameStats.h>
+#include <models/Geometry.h>
+#include <models/Loader.h>
+#include <renderEngine/DisplayManager.h>
+#include <renderEngine/GLState.h>
+#include <gameEngine/World.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+using std::vector;
+
+typedef void (APIENTRYP DrawArraysInstancedBaseInstanceProc)(GLenum mode, GLint first, GLsizei count,
+                                                             GLsizei instanceCount, GLuint baseInstance);
+static DrawArraysInstancedBaseInstanceProc drawArraysInstancedBaseInstance;
+
+unsigned int ParticleShader::instanceVboID;
+int ParticleShader::attributeOffset;
+
+struct InstancedAttribute {
+  unsigned int attribute;
+  int dataSize;
+  int byteOffset;
+};
+
+const InstancedAttribute INSTANCED_ATTRIBUTES[] = {
+  { 2, 3, offsetof(ParticleRecord, origin) },
+  { 3, 3, offsetof(ParticleRecord, velocity) },
+  { 4, 3, offsetof(ParticleRecord, color) },
+  { 5, 1, offsetof(ParticleRecord, scale) },
+  { 6, 1, offsetof(ParticleRecord, spawnTime) },
+};
+
+ParticleShader::ParticleShader(bool isShadow): isShadow(isShadow) {
+  if (isShadow) {
+    const char* VERTEX_FILE = "../shaders/particleShadow.vert";
+    const char* FRAGMENT_FILE = "../shaders/shadow.frag";
+    ShaderProgram::init(VERTEX_FILE, FRAGMENT_FILE);
+  } else {
+    const char* VERTEX_FILE = "../shaders/particle.vert";
+    const char* FRAGMENT_FILE = "../shaders/particle.frag";
+    ShaderProgram::init(VERTEX_FILE, FRAGMENT_FILE, nullptr, fogDefines(FOG::END));
+  }
+}
+
+void ParticleShader::init() {
+  // the particle model keeps the buffer alive along with the vao reading it
+  GpuHandle instanceVbo = Loader::createEmptyVBO(ParticleHolder::maxCapacity() * sizeof(ParticleRecord));
+  Geometry::particle->addBuffer(instanceVbo);
+  instanceVboID = instanceVbo.getID();
+  for (const InstancedAttribute& attribute : INSTANCED_ATTRIBUTES) {
+    Loader::addInstancedAttribute(Geometry::particle->getVaoID(), instanceVboID, attribute.attribute,
+                                  attribute.dataSize, sizeof(ParticleRecord), attribute.byteOffset);
+    glEnableVertexAttribArray(attribute.attribute);
+  }
+  attributeOffset = 0;
+
+  // core since 4.2, the context asks for 3.3 so the extension counts as well
+  int major = 0, minor = 0, count = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &major);
+  glGetIntegerv(GL_MINOR_VERSION, &minor);
+  bool baseInstance = major > 4 || (major == 4 && minor >= 2);
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (int i = 0; i < count && !baseInstance; ++i)
+    baseInstance = strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), "GL_ARB_base_instance") == 0;
+  drawArraysInstancedBaseInstance = baseInstance ?
+    (DrawArraysInstancedBaseInstanceProc)DisplayManager::getProcAddress("glDrawArraysInstancedBaseInstance") : nullptr;
+}
+
+void ParticleShader::upload() {
+  // only records spawned since the last frame are sent to the gpu
+  int begin, count;
+  if (!ParticleHolder::theOne().consumeDirtyRange(begin, count))
+    return;
+  const vector<ParticleRecord>& records = ParticleHolder::theOne().getRecords();
+  int first = std::min(count, ParticleHolder::theOne().getCapacity() - begin);
+  Loader::updateVBO(instanceVboID, begin * sizeof(ParticleRecord), first * sizeof(ParticleRecord), &records[begin]);
+  if (count > first)
+    Loader::updateVBO(instanceVboID, 0, (count - first) * sizeof(ParticleRecord), &records[0]);
+}
+
+void ParticleShader::bindAttributes() {
+  bindAttribute(0, "position");
+  bindAttribute(1, "normal");
+  bindAttribute(2, "origin");
+  bindAttribute(3, "velocity");
+  bindAttribute(4, "color");
+  bindAttribute(5, "scale");
+  bindAttribute(6, "spawnTime");
+}
+
+void ParticleShader::getAllUniformLocations() {
+  ShaderProgram::getAllUniformLocations();
+  location_projectionMatrix = getUniformLocation("projectionMatrix");
+  location_viewMatrix = getUniformLocation("viewMatrix");
+  location_light = getUniformLocation("lightPos");
+  location_time = getUniformLocation("time");
+  location_lifespan = getUniformLocation("lifespan");
+}
+
+void ParticleShader::render() {
+  ParticleHolder& holder = ParticleHolder::theOne();
+  int count = holder.getCount();
+  if (!count)
+    return;
+
+  start();
+  GLState::theOne().enable(GL_DEPTH_TEST);
+  if (isShadow) {
+    GLState::theOne().disable(GL_CULL_FACE);
+    loadMatrix4f(location_lightSpaceMatrix, Camera::primary().getLightSpaceMatrix());
+  } else {
+    GLState::theOne().enable(GL_BLEND);
+    GLState::theOne().enable(GL_CULL_FACE);
+    loadFloat(location_ambientLightIntensity, World::current().ambientLightIntensity);
+    loadVector3f(location_light, Light::theOne().getPosition());
+    loadMatrix4f(location_viewMatrix, Camera::primary().getViewMatrix());
+    loadMatrix4f(location_projectionMatrix, Camera::primary().getProjectionMatrix());
+  }
+  loadFloat(location_time, World::current().timer);
+  loadFloat(location_lifespan, (float)LIFESPAN);
+
+  Geometry::particle->bind();
+  // the live range of the ring may wrap around
+  int tail = holder.getTail();
+  int first = std::min(count, holder.getCapacity() - tail);
+  drawRange(tail, first);
+  if (count > first)
+    drawRange(0, count - first);
+}
+
+void ParticleShader::drawRange(int first, int count) {
+  int vertexCount = Geometry::particle->getVertexCount();
+  if (drawArraysInstancedBaseInstance) {
+    // the vao keeps pointing at record 0, the base instance starts the range
+    drawArraysInstancedBaseInstance(GL_TRIANGLES, 0, vertexCount, count, first);
+  } else {
+    // otherwise the pointers move, but only when the range starts elsewhere
+    if (first != attributeOffset) {
+      for (const InstancedAttribute& attribute : INSTANCED_ATTRIBUTES) {
+        Loader::addInstancedAttribute(Geometry::particle->getVaoID(), instanceVboID, attribute.attribute, attribute.dataSize,
+                                      sizeof(ParticleRecord), first * sizeof(ParticleRecord) + attribute.byteOffset);
+      }
+      attributeOffset = first;
+    }
+    glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, count);
+  }
+  FrameStats::theOne().addDraw((long long)vertexCount / 3 * count);
+}
@@ -0,0 +1,27 @@
+// ParticleShader.h
+#pragma once
+#include "ShaderProgram.h"
+
+class ParticleShader: public ShaderProgram {
+private:
+  bool isShadow;
+  static unsigned int instanceVboID;
+  // first record the instanced attributes of the vao point at
+  static int attributeOffset;
+
+  void drawRange(int first, int count);
+protected:
+  int location_projectionMatrix;
+  int location_viewMatrix;
+  int location_light;
+  int location_time;
+  int location_lifespan;
+  void bindAttributes();
+  void getAllUniformLocations();
+public:
+  ParticleShader(bool isShadow = false);
+  static void init();
+  static void upload();
+
+  void render();
+};
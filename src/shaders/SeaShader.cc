@@ -1,29 +1,36 @@
 // SeaShader.cc
 #include "SeaShader.h"
+#include "ShadowShader.h"
 #include "glPrerequisites.h"
 #include <common.h>
 #include <entities/Entity.h>
 #include <entities/gameObjects/Light.h>
 #include <entities/gameObjects/Camera.h>
+#include <gameEngine/FrameStats.h>
 #include <models/Geometry.h>
+#include <renderEngine/GLState.h>
 #include <utils/Debug.h>
+#include <gameEngine/World.h>
 #include <iostream>
 using std::cout;
 
 Entity* SEA_MODEL;
 
 SeaShader::SeaShader() {
-  SEA_MODEL = new Entity(Geometry::sea, glm::vec3(0.0f, -SEA::RADIUS, 0.0f));
-  SEA_MODEL->changeRotation(glm::vec3(1.0f, 0.0f, 0.0f), glm::radians(90.0f));
-
   const char* VERTEX_FILE = "../shaders/sea.vert";
   const char* FRAGMENT_FILE = "../shaders/sea.frag";
   const char* GEOMETRY_FILE = "../shaders/sea.geom";
-  ShaderProgram::init(VERTEX_FILE, FRAGMENT_FILE, GEOMETRY_FILE);
+  ShaderProgram::init(VERTEX_FILE, FRAGMENT_FILE, GEOMETRY_FILE, fogDefines(FOG::SEA_END) + ShadowShader::receiverDefines());
+}
+
+void SeaShader::init() {
+  SEA_MODEL = new Entity(Geometry::sea, glm::vec3(0.0f, -SEA::RADIUS, 0.0f));
+  SEA_MODEL->changeRotation(glm::vec3(1.0f, 0.0f, 0.0f), glm::radians(90.0f));
 }
 
 SeaShader::~SeaShader() {
   delete SEA_MODEL;
+  SEA_MODEL = nullptr;
 }
 
 void SeaShader::bindAttributes() {
@@ -36,31 +43,34 @@ void SeaShader::getAllUniformLocations() {
   location_projectionMatrix = getUniformLocation("projectionMatrix");
   location_viewMatrix = getUniformLocation("viewMatrix");
   location_time = getUniformLocation("time");
+  location_positionScale = getUniformLocation("positionScale");
   location_light = getUniformLocation("lightPos");
   location_shadowMap = getUniformLocation("shadowMap");
+  location_dynamicShadowMap = getUniformLocation("dynamicShadowMap");
 }
 
 void SeaShader::render() {
   start();
-  glDisable(GL_CULL_FACE);
-  glEnable(GL_DEPTH_TEST);
-  glEnable(GL_BLEND);
+  GLState::theOne().disable(GL_CULL_FACE);
+  GLState::theOne().enable(GL_DEPTH_TEST);
+  GLState::theOne().enable(GL_BLEND);
   glm::vec3 lightPos(Light::theOne().getPosition());
-  loadFloat(location_ambientLightIntensity, AMBIENT_LIGHT_INTENSITY);
+  loadFloat(location_ambientLightIntensity, World::current().ambientLightIntensity);
   loadInt(location_shadowMap, 0);
-  loadFloat(location_time, TIMER);
+  loadInt(location_dynamicShadowMap, 1);
+  loadFloat(location_time, World::current().timer);
   loadVector3f(location_light, lightPos);
   loadMatrix4f(location_lightSpaceMatrix, Camera::primary().getLightSpaceMatrix());
   loadMatrix4f(location_viewMatrix, Camera::primary().getViewMatrix());
   loadMatrix4f(location_projectionMatrix, Camera::primary().getProjectionMatrix());
   RawModel* model = SEA_MODEL->getModel();
+  loadFloat(location_positionScale, model->getPositionScale());
   loadMatrix4f(location_transformationMatrix, SEA_MODEL->getTransformationMatrix());
   model->bind();
 
-  glDrawElements(GL_TRIANGLES, model->getVertexCount(), GL_UNSIGNED_INT, (void*) 0);
-
-  RawModel::unbind();
-  stop();
+  const LodLevel& lod = model->getLod(SEA_MODEL->selectLod());
+  glDrawElements(GL_TRIANGLES, lod.count, model->getIndexType(), (void*) (intptr_t) (lod.first * model->getIndexSize()));
+  FrameStats::theOne().addDraw(lod.count / 3);
 
   // update sea
   SEA_MODEL->changeRotation(glm::vec3(0.0f, 0.0f, 1.0f), GAME::SPEED);
@@ -7,12 +7,16 @@ protected:
   int location_projectionMatrix;
   int location_viewMatrix;
   int location_time;
+  int location_positionScale;
   int location_light;
   int location_shadowMap;
+  int location_dynamicShadowMap;
   void bindAttributes();
   void getAllUniformLocations();
 public:
   SeaShader();
+  // places the sea, once the geometry is uploaded
+  void init();
 
   void render();
 
@@ -0,0 +1,79 @@
+// ShaderCompiler.cc
+#include "ShaderCompiler.h"
+#include "ShaderProgram.h"
+#include "glPrerequisites.h"
+#include <renderEngine/DisplayManager.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+using std::cout;
+
+typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+
+ShaderCompiler::ShaderCompiler(): parallel(false), submitted(0), completedInBackground(0) {}
+
+ShaderCompiler& ShaderCompiler::theOne() {
+  static ShaderCompiler compiler;
+  return compiler;
+}
+
+void ShaderCompiler::init() {
+  // the ARB extension is the same one under another name
+  int count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (int i = 0; i < count && !parallel; ++i) {
+    const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+    parallel = strcmp(extension, "GL_KHR_parallel_shader_compile") == 0 ||
+               strcmp(extension, "GL_ARB_parallel_shader_compile") == 0;
+  }
+  if (!parallel)
+    return;
+
+  MaxShaderCompilerThreadsProc maxThreads =
+    (MaxShaderCompilerThreadsProc)DisplayManager::getProcAddress("glMaxShaderCompilerThreadsKHR");
+  if (!maxThreads)
+    maxThreads = (MaxShaderCompilerThreadsProc)DisplayManager::getProcAddress("glMaxShaderCompilerThreadsARB");
+  // leaves the number of compiler threads to the driver
+  if (maxThreads)
+    maxThreads(0xffffffffu);
+}
+
+bool ShaderCompiler::isParallel() const {
+  return parallel;
+}
+
+void ShaderCompiler::submit(ShaderProgram* program) {
+  pending.push_back(program);
+  ++submitted;
+}
+
+void ShaderCompiler::remove(ShaderProgram* program) {
+  pending.erase(std::remove(pending.begin(), pending.end(), program), pending.end());
+}
+
+void ShaderCompiler::poll() {
+  if (!parallel)
+    return;
+  // finishing a program removes it from the list
+  std::vector<ShaderProgram*> programs(pending);
+  for (ShaderProgram* program : programs) {
+    if (program->isCompleted()) {
+      program->finish();
+      ++completedInBackground;
+    }
+  }
+}
+
+void ShaderCompiler::finishAll() {
+  std::vector<ShaderProgram*> programs(pending);
+  for (ShaderProgram* program : programs)
+    program->finish();
+}
+
+int ShaderCompiler::getSubmitted() const {
+  return submitted;
+}
+
+int ShaderCompiler::getCompletedInBackground() const {
+  return completedInBackground;
+}
@@ -0,0 +1,36 @@
+// ShaderCompiler.h
+#pragma once
+#include <vector>
+
+class ShaderProgram;
+
+// programs are compiled and linked as soon as they are created, but their
+// status is only read when they are first used, so the driver can work on
+// all of them at once. With GL_KHR_parallel_shader_compile the driver does
+// so on its own threads and poll() picks up finished programs without
+// blocking
+class ShaderCompiler {
+private:
+  bool parallel;
+  std::vector<ShaderProgram*> pending;
+  int submitted, completedInBackground;
+
+  ShaderCompiler();
+public:
+  static ShaderCompiler& theOne();
+
+  // looks for the extension, needs a current context
+  void init();
+  bool isParallel() const;
+
+  void submit(ShaderProgram* program);
+  void remove(ShaderProgram* program);
+  // finishes every program the driver is done with, never blocks
+  void poll();
+  // blocks on the programs still pending, those the polls picked up are done
+  void finishAll();
+
+  int getSubmitted() const;
+  // programs that were already linked when polled
+  int getCompletedInBackground() const;
+};
@@ -1,30 +1,69 @@
 // ShaderProgram.cc
 #include "ShaderProgram.h"
+#include "ShaderCompiler.h"
 #include "glPrerequisites.h"
+#include <common.h>
+#include <gameEngine/FrameStats.h>
+#include <renderEngine/GLState.h>
 #include <glm/gtc/type_ptr.hpp>
 #include <fstream>
 #include <iostream>
-#include <sstream>
+#include <stdexcept>
 #include <string>
 using std::cout;
 
-void ShaderProgram::init(const char*vertexFileName, const char* fragmentFileName, const char* geometryFileName) {
+ShaderProgram::ShaderProgram(unsigned int variantKey)
+  : linked(false), programID(0), vertexShaderID(0), fragmentShaderID(0), geometryShaderID(0), variantKey(variantKey) {}
+
+void ShaderProgram::init(const char*vertexFileName, const char* fragmentFileName, const char* geometryFileName, const std::string& defines) {
   programID = glCreateProgram();
-  vertexShaderID = loadShader(vertexFileName, GL_VERTEX_SHADER);
-  fragmentShaderID = loadShader(fragmentFileName, GL_FRAGMENT_SHADER);
+  vertexShaderID = loadShader(vertexFileName, GL_VERTEX_SHADER, defines);
+  fragmentShaderID = loadShader(fragmentFileName, GL_FRAGMENT_SHADER, defines);
   glAttachShader(programID, vertexShaderID);
   glAttachShader(programID, fragmentShaderID);
   if (geometryFileName != nullptr) {
-    geometryShaderID = loadShader(geometryFileName, GL_GEOMETRY_SHADER);
+    geometryShaderID = loadShader(geometryFileName, GL_GEOMETRY_SHADER, defines);
     glAttachShader(programID, geometryShaderID);
   }
   bindAttributes();
+  // no status is read here, that would wait for the driver
   glLinkProgram(programID);
+  ShaderCompiler::theOne().submit(this);
+}
+
+bool ShaderProgram::isCompleted() const {
+  int completed = 0;
+  glGetProgramiv(programID, GL_COMPLETION_STATUS_KHR, &completed);
+  return completed;
+}
+
+void ShaderProgram::checkShader(unsigned int shaderID, const char* stage) {
+  int success;
+  char infoLog[512];
+  glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+  if (!success) {
+    glGetShaderInfoLog(shaderID, 512, NULL, infoLog);
+    std::cout << "==================================================\n";
+    std::cout << "ERROR::SHADER: Failed to compile " << stage << " shader\n\n" << infoLog;
+    std::cout << "\n==================================================\n";
+  }
+}
+
+void ShaderProgram::finish() {
+  if (linked)
+    return;
+  linked = true;
+  ShaderCompiler::theOne().remove(this);
 
   int success;
   char infoLog[512];
   glGetProgramiv(programID, GL_LINK_STATUS, &success);
   if (!success) {
+    // the link log rarely names the stage, the compile logs do
+    checkShader(vertexShaderID, "vertex");
+    checkShader(fragmentShaderID, "fragment");
+    if (geometryShaderID != 0)
+      checkShader(geometryShaderID, "geometry");
     glGetProgramInfoLog(programID, 512, NULL, infoLog);
     std::cout << "==================================================\n";
     std::cout << "ERROR::SHADER: Failed to link program\n\n" << infoLog;
@@ -40,15 +79,53 @@ void ShaderProgram::getAllUniformLocations() {
   location_ambientLightIntensity = getUniformLocation("ambientLightIntensity");
 }
 
+std::string ShaderProgram::variantDefines(unsigned int) const {
+  return "";
+}
+
+ShaderProgram* ShaderProgram::createVariant(unsigned int) const {
+  return nullptr;
+}
+
+std::string ShaderProgram::fogDefines(float end) {
+  return "#define FOG_NEAR " + std::to_string(FOG::START) + "\n#define FOG_FAR " + std::to_string(end) + "\n";
+}
+
+ShaderProgram& ShaderProgram::variant(unsigned int key) {
+  if (key == variantKey)
+    return *this;
+  auto it = variants.find(key);
+  if (it != variants.end())
+    return *it->second;
+
+  ShaderProgram* program = createVariant(key);
+  if (program == nullptr) {
+    std::cout << "==================================================\n";
+    std::cout << "ERROR::SHADER: No variant " << key << " for program " << programID;
+    std::cout << "\n==================================================\n";
+    return *this;
+  }
+  variants[key] = program;
+  return *program;
+}
+
 void ShaderProgram::start() {
-  glUseProgram(programID);
+  if (!linked) {
+    // blocking on this one anyway, whatever else is done comes along for free
+    ShaderCompiler::theOne().poll();
+    finish();
+  }
+  GLState::theOne().useProgram(programID);
 }
 
 void ShaderProgram::stop() {
-  glUseProgram(0);
+  GLState::theOne().useProgram(0);
 }
 
 ShaderProgram::~ShaderProgram() {
+  ShaderCompiler::theOne().remove(this);
+  for (auto& entry : variants)
+    delete entry.second;
   stop();
   glDetachShader(programID, vertexShaderID);
   glDeleteShader(vertexShaderID);
@@ -70,58 +147,73 @@ int ShaderProgram::getUniformLocation(const char* uniformName) {
 }
 
 void ShaderProgram::loadInt(int location, int value) {
+  FrameStats::theOne().addUniform();
   glUniform1i(location, value);
 }
 
 void ShaderProgram::loadBool(int location, bool value) {
+  FrameStats::theOne().addUniform();
   glUniform1i(location, value ? 1 : 0);
 }
 
 void ShaderProgram::loadFloat(int location, float value) {
+  FrameStats::theOne().addUniform();
   glUniform1f(location, value);
 }
 
 void ShaderProgram::loadVector3f(int location, glm::vec3 vec) {
+  FrameStats::theOne().addUniform();
   glUniform3f(location, vec.x ,vec.y, vec.z);
 }
 
 void ShaderProgram::loadVector4f(int location, glm::vec4 vec) {
+  FrameStats::theOne().addUniform();
   glUniform4f(location, vec.x ,vec.y, vec.z, vec.w);
 }
 
 void ShaderProgram::loadMatrix4f(int location, glm::mat4 mat) {
+  FrameStats::theOne().addUniform();
   glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat));
 }
 
-unsigned int ShaderProgram::loadShader(const char* file, unsigned int type) {
-  try {
-    std::fstream fs(file);
-    if (!fs.good()) {
-      throw std::exception();
+std::string ShaderProgram::readSource(const std::string& file, int depth) {
+  std::fstream fs(file);
+  if (!fs.good() || depth > MAX_INCLUDE_DEPTH)
+    throw std::runtime_error(file);
+
+  // #include "name" lines are replaced by that file, named relative to this one
+  std::string directory = file.substr(0, file.find_last_of('/') + 1);
+  std::string source, line;
+  while (std::getline(fs, line)) {
+    size_t open = line.find('"');
+    size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+    if (line.compare(0, 8, "#include") == 0 && close != std::string::npos) {
+      source += readSource(directory + line.substr(open + 1, close - open - 1), depth + 1);
+    } else {
+      source += line;
+      source += '\n';
     }
+  }
+  return source;
+}
 
-    std::stringstream ss;
-    ss << fs.rdbuf();
-    std::string shaderSourceString = ss.str();
+unsigned int ShaderProgram::loadShader(const char* file, unsigned int type, const std::string& defines) {
+  try {
+    std::string shaderSourceString = readSource(file, 0);
+    if (!defines.empty()) {
+      size_t version = shaderSourceString.find("#version");
+      size_t lineEnd = version == std::string::npos ? std::string::npos : shaderSourceString.find('\n', version);
+      size_t insertAt = lineEnd == std::string::npos ? 0 : lineEnd + 1;
+      shaderSourceString.insert(insertAt, defines);
+    }
     const char* shaderSource = shaderSourceString.c_str();
     unsigned int shaderID = glCreateShader(type);
     glShaderSource(shaderID, 1, &shaderSource, NULL);
     glCompileShader(shaderID);
-
-    int success;
-    char infoLog[512];
-    glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
-    if (!success) {
-      glGetShaderInfoLog(shaderID, 512, NULL, infoLog);
-      std::cout << "==================================================\n";
-      std::cout << "ERROR::SHADER: Failed to compile shader\n\n" << infoLog;
-      std::cout << "\n==================================================\n";
-    }
-
     return shaderID;
   } catch (std::exception& e) {
     std::cout << "==================================================\n";
-    std::cout << "ERROR::SHADER: Failed to read file\n";
+    std::cout << "ERROR::SHADER: Failed to read file ";
     std::cout << e.what();
     std::cout << "\n==================================================\n";
     return 0;
@@ -1,10 +1,20 @@
 // ShaderProgram.h
 #pragma once
 #include <glm/glm.hpp>
+#include <map>
+#include <string>
 
 class ShaderProgram {
 private:
-  static unsigned int loadShader(const char* file, unsigned int type);
+  // nested includes past this are taken for a cycle
+  static const int MAX_INCLUDE_DEPTH = 8;
+  static std::string readSource(const std::string& file, int depth);
+  static unsigned int loadShader(const char* file, unsigned int type, const std::string& defines);
+  std::map<unsigned int, ShaderProgram*> variants;
+  // false until the link status was read and the uniforms were looked up
+  bool linked;
+
+  static void checkShader(unsigned int shaderID, const char* stage);
 protected:
   unsigned int programID;
   unsigned int vertexShaderID;
@@ -15,6 +25,17 @@ protected:
   int location_lightSpaceMatrix;
   int location_ambientLightIntensity;
 
+  // permutation key this program was compiled with, its bits are defined by
+  // the subclass and turned into #defines by variantDefines()
+  unsigned int variantKey;
+  virtual std::string variantDefines(unsigned int key) const;
+  // compiles a program of the same kind for key, nullptr if it has no variants
+  virtual ShaderProgram* createVariant(unsigned int key) const;
+  // FOG_NEAR and FOG_FAR for the fragment stage, fog reaching from FOG::START to end
+  static std::string fogDefines(float end);
+  // the program compiled for key, built on first use and cached afterwards
+  ShaderProgram& variant(unsigned int key);
+
   virtual void getAllUniformLocations();
   virtual void bindAttributes() = 0;
   void bindAttribute(unsigned int attribute, const char* variable);
@@ -26,7 +47,14 @@ protected:
   void loadVector4f(int location, glm::vec4 vec);
   void loadMatrix4f(int location, glm::mat4 mat);
 public:
-  void init(const char* vertexFileName, const char* fragmentFileName, const char* geometryFileName = nullptr);
+  ShaderProgram(unsigned int variantKey = 0);
+  // defines are inserted right after the #version line of every stage. The
+  // program is submitted to the ShaderCompiler and finished on first use
+  void init(const char* vertexFileName, const char* fragmentFileName, const char* geometryFileName = nullptr, const std::string& defines = "");
+  // true once the driver is done, without blocking; only meaningful with parallel compilation
+  bool isCompleted() const;
+  // blocks until linked, reports errors and looks up the uniforms
+  void finish();
   void start();
   void stop();
   virtual ~ShaderProgram();
@@ -5,140 +5,154 @@
 #include <entities/Entity.h>
 #include <entities/DynamicEntity.h>
 #include <entities/gameObjects/Camera.h>
-#include <entities/gameObjects/ParticleHolder.h>
+#include <gameEngine/FrameStats.h>
 #include <glm/glm.hpp>
-#include <cassert>
+#include <gameEngine/World.h>
+#include <renderEngine/GLState.h>
 #include <iostream>
 using std::vector;
 
-unsigned int ShadowShader::fboID;
-Texture ShadowShader::depthMap;
-
-ShadowShader::ShadowShader(bool isSeaShadow): isSeaShadow(isSeaShadow) {
-  if (isSeaShadow) {
-    const char* VERTEX_FILE = "../shaders/seaShadow.vert";
-    const char* FRAGMENT_FILE = "../shaders/seaShadow.frag";
-    ShaderProgram::init(VERTEX_FILE, FRAGMENT_FILE);
-  } else {
-    const char* VERTEX_FILE = "../shaders/entityShadow.vert";
-    const char* FRAGMENT_FILE = "../shaders/entityShadow.frag";
-    ShaderProgram::init(VERTEX_FILE, FRAGMENT_FILE);
-  }
+Texture ShadowShader::depthMaps[SHADOW_LAYERS];
+GpuHandle ShadowShader::depthStorage[SHADOW_LAYERS];
+
+ShadowShader::ShadowShader(unsigned int variantKey) : ShaderProgram(variantKey) {
+  const char* VERTEX_FILE = "../shaders/shadow.vert";
+  const char* FRAGMENT_FILE = "../shaders/shadow.frag";
+  ShaderProgram::init(VERTEX_FILE, FRAGMENT_FILE, nullptr, ShadowShader::variantDefines(variantKey));
+}
+
+std::string ShadowShader::variantDefines(unsigned int key) const {
+  return key & SEA_WAVES ? "#define SEA_WAVES\n" : "";
+}
+
+ShaderProgram* ShadowShader::createVariant(unsigned int key) const {
+  return new ShadowShader(key);
 }
 
 void ShadowShader::init() {
-  glGenFramebuffers(1, &fboID);
-  unsigned int textureID;
-  glGenTextures(1, &textureID);
-  depthMap.setTextureID(textureID);
-
-  glBindTexture(GL_TEXTURE_2D, textureID);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, SHADOW::WIDTH, SHADOW::HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  for (int layer = 0; layer < SHADOW_LAYERS; ++layer) {
+    initLayer((ShadowLayer)layer);
+  }
+}
+
+void ShadowShader::cleanLayers() {
+  for (int layer = 0; layer < SHADOW_LAYERS; ++layer) {
+    depthStorage[layer].reset();
+    depthMaps[layer].setTextureID(0);
+  }
+}
+
+// the frame graph attaches the maps to framebuffers when a layer is drawn
+void ShadowShader::initLayer(ShadowLayer layer) {
+  // the light projection is orthographic, so depth is linear and 16 bits are usually enough
+  unsigned int internalFormat = GL_DEPTH_COMPONENT16, type = GL_UNSIGNED_SHORT;
+  if (SHADOW::DEPTH_BITS == 24) {
+    internalFormat = GL_DEPTH_COMPONENT24;
+    type = GL_UNSIGNED_INT;
+  } else if (SHADOW::DEPTH_BITS == 32) {
+    internalFormat = GL_DEPTH_COMPONENT32F;
+    type = GL_FLOAT;
+  }
+  depthStorage[layer] = GpuResources::theOne().createTexture(
+    MemoryTracker::textureBytes(internalFormat, SHADOW::WIDTH, SHADOW::HEIGHT), MEMORY_TEXTURES);
+  depthMaps[layer].setTextureID(depthStorage[layer].getID());
+  GLState::theOne().bindTexture(0, GL_TEXTURE_2D, depthStorage[layer].getID());
+  glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, SHADOW::WIDTH, SHADOW::HEIGHT, 0, GL_DEPTH_COMPONENT, type, NULL);
+  // sampled through sampler2DShadow, linear filtering gives bilinear PCF per tap
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
   float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
   glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-
-  glBindFramebuffer(GL_FRAMEBUFFER, fboID);
-  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, textureID, 0);
-  glDrawBuffer(GL_NONE);
-  glReadBuffer(GL_NONE);
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-  assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
 }
 
 void ShadowShader::bindAttributes() {
   bindAttribute(0, "position");
-  if (isSeaShadow)
+  if (variantKey & SEA_WAVES)
     bindAttribute(1, "wave");
 }
 
 void ShadowShader::getAllUniformLocations() {
   ShaderProgram::getAllUniformLocations();
-  if (isSeaShadow)
-    location_time = getUniformLocation("time");
+  location_time = getUniformLocation("time");
+  location_positionScale = getUniformLocation("positionScale");
+}
+
+void ShadowShader::render(ShadowLayer layer) {
+  if (layer == SHADOW_STATIC)
+    static_cast<ShadowShader&>(variant(SEA_WAVES)).renderSea();
+  else
+    static_cast<ShadowShader&>(variant(0)).renderEntities();
 }
 
-void ShadowShader::render() {
+void ShadowShader::compileVariants() {
+  variant(SEA_WAVES);
+  variant(0);
+}
+
+void ShadowShader::renderSea() {
   start();
-  glEnable(GL_DEPTH_TEST);
-  glDisable(GL_CULL_FACE);
+  GLState::theOne().enable(GL_DEPTH_TEST);
+  GLState::theOne().disable(GL_CULL_FACE);
   loadMatrix4f(location_lightSpaceMatrix, Camera::primary().getLightSpaceMatrix());
-  if (isSeaShadow) {
-    loadFloat(location_time, TIMER);
-    RawModel* model = SEA_MODEL->getModel();
-    loadMatrix4f(location_transformationMatrix, SEA_MODEL->getTransformationMatrix());
-    model->bind();
-
-    glDrawElements(GL_TRIANGLES, model->getVertexCount(), GL_UNSIGNED_INT, (void*) 0);
-
-    RawModel::unbind();
-  } else {
-    for (auto& entry: staticEntities) {
-      vector<Entity*>& entities = entry.second;
-      entry.first->bind();
-      for (int i = 0; i < entities.size(); ++i) {
-        Entity* entity = entities[i];
-        if (!entity->getCastShadow())
-          continue;
-        RawModel* model = entity->getModel();
-        loadMatrix4f(location_transformationMatrix, entity->getTransformationMatrix());
-        glDrawArrays(GL_TRIANGLES, 0, model->getVertexCount());
-      }
-      RawModel::unbind();
-    }
+  loadFloat(location_time, World::current().timer);
+  RawModel* model = SEA_MODEL->getModel();
+  loadFloat(location_positionScale, model->getPositionScale());
+  loadMatrix4f(location_transformationMatrix, SEA_MODEL->getTransformationMatrix());
+  model->bind();
+
+  const LodLevel& lod = model->getLod(SEA_MODEL->selectLod(SHADOW_LOD_BIAS));
+  glDrawElements(GL_TRIANGLES, lod.count, model->getIndexType(), (void*) (intptr_t) (lod.first * model->getIndexSize()));
+  FrameStats::theOne().addDraw(lod.count / 3);
+}
 
-    for (auto& entry: dynamicEntities) {
-      vector<DynamicEntity*>& entities = entry.second;
-      entry.first->bind();
-      for (int i = 0; i < entities.size(); ++i) {
-        DynamicEntity* entity = entities[i];
-        if (!entity->getCastShadow())
-          continue;
-        RawModel* model = entity->getModel();
-        loadMatrix4f(location_transformationMatrix, entity->getTransformationMatrix());
-        glDrawArrays(GL_TRIANGLES, 0, model->getVertexCount());
-      }
-      RawModel::unbind();
+void ShadowShader::renderEntities() {
+  start();
+  GLState::theOne().enable(GL_DEPTH_TEST);
+  GLState::theOne().disable(GL_CULL_FACE);
+  loadMatrix4f(location_lightSpaceMatrix, Camera::primary().getLightSpaceMatrix());
+  for (auto& entry: World::current().staticEntities) {
+    vector<Entity*>& entities = entry.second;
+    entry.first->bindDepth();
+    for (int i = 0; i < entities.size(); ++i) {
+      Entity* entity = entities[i];
+      if (!entity->getCastShadow())
+        continue;
+      RawModel* model = entity->getModel();
+      loadMatrix4f(location_transformationMatrix, entity->getTransformationMatrix());
+      const LodLevel& lod = model->getLod(entity->selectLod(SHADOW_LOD_BIAS));
+      glDrawArrays(GL_TRIANGLES, lod.first, lod.count);
+      FrameStats::theOne().addDraw(lod.count / 3);
     }
-
-    vector<DynamicEntity*> particles = ParticleHolder::getParticles();
-    if (particles.size())
-      particles[0]->getModel()->bind();
-      for (int i = 0; i < particles.size(); ++i) {
-        DynamicEntity* particle = particles[i];
-        if (!particle->getCastShadow())
-          continue;
-        RawModel* model = particle->getModel();
-        loadMatrix4f(location_transformationMatrix, particle->getTransformationMatrix());
-        glDrawArrays(GL_TRIANGLES, 0, model->getVertexCount());
-      }
-      RawModel::unbind();
   }
 
-  stop();
-}
-
-void ShadowShader::clean() {
-  stop();
-  glDetachShader(programID, vertexShaderID);
-  glDeleteShader(vertexShaderID);
-  if (geometryShaderID != 0) {
-    glDetachShader(programID, geometryShaderID);
-    glDeleteShader(geometryShaderID);
+  for (auto& entry: World::current().dynamicEntities) {
+    vector<DynamicEntity*>& entities = entry.second;
+    entry.first->bindDepth();
+    for (int i = 0; i < entities.size(); ++i) {
+      DynamicEntity* entity = entities[i];
+      if (!entity->getCastShadow())
+        continue;
+      RawModel* model = entity->getModel();
+      loadMatrix4f(location_transformationMatrix, entity->getTransformationMatrix());
+      const LodLevel& lod = model->getLod(entity->selectLod(SHADOW_LOD_BIAS));
+      glDrawArrays(GL_TRIANGLES, lod.first, lod.count);
+      FrameStats::theOne().addDraw(lod.count / 3);
+    }
   }
-  glDetachShader(programID, fragmentShaderID);
-  glDeleteShader(fragmentShaderID);
-  glDeleteProgram(programID);
 }
 
-unsigned int ShadowShader::getFboID() {
-  return fboID;
+std::string ShadowShader::receiverDefines() {
+  int taps = SHADOW::KERNEL_TAPS;
+  if (taps != 1 && taps != 4 && taps != 9 && taps != 16)
+    taps = 4;
+  return "#define SHADOW_KERNEL_TAPS " + std::to_string(taps) + "\n" +
+         "#define SHADOW_DEPTH_RANGE " + std::to_string(Camera::shadowDepthRange()) + "\n";
 }
 
-Texture& ShadowShader::getDepthMap() {
-  return depthMap;
+Texture& ShadowShader::getDepthMap(ShadowLayer layer) {
+  return depthMaps[layer];
 }
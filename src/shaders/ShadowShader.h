@@ -1,24 +1,48 @@
 // SeaShader.h
 #pragma once
 #include "ShaderProgram.h"
+#include <renderEngine/GpuResources.h>
 #include <textures/Texture.h>
 
+// the sea is drawn into the static layer, everything else into the dynamic
+// layer, and receivers merge both when sampling
+enum ShadowLayer {
+  SHADOW_STATIC,
+  SHADOW_DYNAMIC,
+  SHADOW_LAYERS
+};
+
 class ShadowShader: public ShaderProgram {
 private:
-  bool isSeaShadow;
-  static unsigned int fboID;
-  static Texture depthMap;
+  static Texture depthMaps[SHADOW_LAYERS];
+  static GpuHandle depthStorage[SHADOW_LAYERS];
 protected:
   int location_time;
+  int location_positionScale;
   void bindAttributes();
   void getAllUniformLocations();
+  std::string variantDefines(unsigned int key) const;
+  ShaderProgram* createVariant(unsigned int key) const;
+  void renderSea();
+  void renderEntities();
+  static void initLayer(ShadowLayer layer);
 public:
-  ShadowShader(bool isSeaShadow = false);
+  enum Variant {
+    SEA_WAVES = 1 << 0,
+  };
+
+  ShadowShader(unsigned int variantKey = 0);
   static void init();
+  // frees the depth maps
+  static void cleanLayers();
 
-  void render();
-  void clean();
+  // the static layer holds the sea, the dynamic layer the entities
+  void render(ShadowLayer layer);
+  // compiles the variants render() uses ahead of the first frame
+  void compileVariants();
 
-  static unsigned int getFboID();
-  static Texture& getDepthMap();
+  static Texture& getDepthMap(ShadowLayer layer);
+  // defines shadow receivers are built with: the PCF kernel and the depth
+  // range their biases are scaled by
+  static std::string receiverDefines();
 };
@@ -4,27 +4,29 @@
 #include <common.h>
 #include <models/RawModel.h>
 #include <models/Loader.h>
-#include <vector>
+#include <renderEngine/GLState.h>
+#include <textures/FontAtlas.h>
+#include <gameEngine/FrameStats.h>
+#include <gameEngine/Game.h>
+#include <gameEngine/World.h>
+#include <glm/gtc/packing.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
 #include <iostream>
 using std::vector;
 using std::cout;
 
-UIShader::UIShader(): quad(nullptr) {
-  vector<float> vertices;
-  vertices.push_back(-1.0f);
-  vertices.push_back(1.0f);
-  vertices.push_back(1.0f);
-  vertices.push_back(1.0f);
-  vertices.push_back(1.0f);
-  vertices.push_back(-1.0f);
-
-  vertices.push_back(1.0f);
-  vertices.push_back(-1.0f);
-  vertices.push_back(-1.0f);
-  vertices.push_back(-1.0f);
-  vertices.push_back(-1.0f);
-  vertices.push_back(1.0f);
-  quad = Loader::loadToVAO(vertices, 2);
+UIShader::UIShader(): quads(nullptr) {
+  FontAtlas::theOne().init();
+  vertices.reserve(MAX_QUADS * 6);
+  GpuHandle vbo = Loader::createEmptyVBO(MAX_QUADS * 6 * sizeof(UIVertex));
+  vboID = vbo.getID();
+  vector<StreamAttribute> attributes;
+  attributes.push_back({ 0, 2, GL_FLOAT, false, offsetof(UIVertex, position) });
+  attributes.push_back({ 1, 2, GL_FLOAT, false, offsetof(UIVertex, uv) });
+  attributes.push_back({ 2, 4, GL_UNSIGNED_BYTE, true, offsetof(UIVertex, color) });
+  quads = Loader::loadStreamToVAO(vbo, sizeof(UIVertex), attributes);
 
   const char* VERTEX_FILE = "../shaders/ui.vert";
   const char* FRAG_FILE = "../shaders/ui.frag";
@@ -32,30 +34,170 @@ UIShader::UIShader(): quad(nullptr) {
 }
 
 UIShader::~UIShader() {
-  if (quad)
-    delete quad;
+  if (quads)
+    delete quads;
+  FontAtlas::theOne().clean();
 }
 
 void UIShader::bindAttributes() {
   bindAttribute(0, "position");
+  bindAttribute(1, "uv");
+  bindAttribute(2, "color");
 }
 
 void UIShader::getAllUniformLocations() {
-  location_health = getUniformLocation("health");
   location_width = getUniformLocation("width");
   location_height = getUniformLocation("height");
+  location_atlas = getUniformLocation("atlas");
+}
+
+void UIShader::addQuad(glm::vec4 rect, glm::vec4 uv, glm::vec4 color) {
+  if (vertices.size() + 6 > MAX_QUADS * 6)
+    return;
+  uint32_t packed = glm::packUnorm4x8(color);
+  UIVertex corners[4] = {
+    { { rect.x, rect.y }, { uv.x, uv.y }, packed },
+    { { rect.z, rect.y }, { uv.z, uv.y }, packed },
+    { { rect.z, rect.w }, { uv.z, uv.w }, packed },
+    { { rect.x, rect.w }, { uv.x, uv.w }, packed },
+  };
+  const int order[6] = { 0, 1, 2, 2, 3, 0 };
+  for (int i : order)
+    vertices.push_back(corners[i]);
+}
+
+void UIShader::drawRect(glm::vec4 rect, glm::vec4 color) {
+  addQuad(rect, FontAtlas::theOne().getSolid(), color);
+}
+
+void UIShader::drawText(glm::vec2 position, float size, const std::string& text, glm::vec4 color) {
+  // the glyph fills 3/4 of its cell's height, the cell is square
+  float cell = size / 0.75f;
+  float advance = FontAtlas::ADVANCE * size;
+  glm::vec2 origin = position - glm::vec2(0.5f * (cell - advance), 0.125f * cell);
+  for (char c : text) {
+    if (c != ' ')
+      addQuad(glm::vec4(origin.x, origin.y, origin.x + cell, origin.y + cell), FontAtlas::theOne().getGlyph(c), color);
+    origin.x += advance;
+  }
+}
+
+float UIShader::textWidth(float size, const std::string& text) {
+  return FontAtlas::ADVANCE * size * text.size();
+}
+
+void UIShader::buildHud() {
+  World& world = World::current();
+  float width = (float)ACTUAL_WIDTH, height = (float)ACTUAL_HEIGHT;
+  glm::vec4 textColor(BROWN[0], BROWN[1], BROWN[2], 0.9f);
+
+  // health bar, one block per 5 health
+  float size = height / 40;
+  float padding = size / 5;
+  float interval = size + padding;
+  float yOffset = height - 2 * size;
+  float xOffset = 2 * size;
+  float length = (world.health / 5) * interval;
+  glm::vec4 barColor = world.health < 30.0f ? glm::vec4(242.0f/255.0f, 53.0f/255.0f, 30.0f/255.0f, 0.8f)
+                                            : glm::vec4(BLUE[0], BLUE[1], BLUE[2], 0.8f);
+  for (float x = 0.0f; x < length; x += interval) {
+    drawRect(glm::vec4(xOffset + x, yOffset - size, xOffset + std::min(x + size, length), yOffset), barColor);
+  }
+
+  // distance, right aligned on the same line
+  std::string distance = "DISTANCE " + std::to_string((int)world.miles);
+  drawText(glm::vec2(width - xOffset - textWidth(size, distance), yOffset - size), size, distance, textColor);
+
+  if (GAME::DISPLAY_FPS) {
+    std::string fps = "FPS " + std::to_string(Game::theOne().getFPS());
+    drawText(glm::vec2(xOffset, yOffset - 2.5f * size), 0.75f * size, fps, textColor);
+  }
+}
+
+static std::string format(double value, int decimals = 2) {
+  char text[32];
+  snprintf(text, sizeof(text), "%.*f", decimals, value);
+  return text;
+}
+
+void UIShader::buildOverlay() {
+  FrameStats& stats = FrameStats::theOne();
+  const FrameStats::Frame& frame = stats.getLastFrame();
+  float height = (float)ACTUAL_HEIGHT;
+  float size = height / 60;
+  float lineHeight = 1.5f * size;
+  float left = height / 20;
+  float top = height - 6 * height / 40;
+  glm::vec4 textColor(1.0f, 1.0f, 1.0f, 0.95f);
+
+  vector<std::string> lines;
+  lines.push_back("FRAME " + format(frame.frameTime) + " MS  SIM " + format(frame.simTime) +
+                  "  RENDER " + format(frame.renderTime) + "  GPU " + format(frame.gpuTime));
+  lines.push_back("P50 " + format(stats.getPercentile(0.5)) + "  P95 " + format(stats.getPercentile(0.95)) +
+                  "  P99 " + format(stats.getPercentile(0.99)));
+  lines.push_back("DRAWS " + std::to_string(frame.drawCalls) + "  TRIANGLES " + std::to_string(frame.triangles) +
+                  "  UNIFORMS " + std::to_string(frame.uniformUploads));
+  lines.push_back("STATE CHANGES " + std::to_string(frame.stateSubmitted) +
+                  "  FILTERED " + std::to_string(frame.stateFiltered));
+  lines.push_back("OBSTACLES " + std::to_string(frame.obstacles) + "  BATTERIES " + std::to_string(frame.batteries) +
+                  "  CLOUDS " + std::to_string(frame.clouds));
+  lines.push_back("PARTICLES " + std::to_string(frame.particles) + "  ENTITIES " + std::to_string(frame.entities));
+  lines.push_back("MEMORY " + format(frame.memoryLive / 1048576.0) + " MB  PEAK " + format(frame.memoryPeak / 1048576.0) +
+                  "  GPU " + format(frame.memoryGpu / 1048576.0));
+  for (auto& pass : frame.passTimes)
+    lines.push_back("  " + pass.first + " " + format(pass.second) + " MS");
+
+  // frame time graph below the text, one bar per frame of history
+  float graphWidth = 40 * size;
+  float graphHeight = 6 * size;
+  float padding = size / 2;
+  float width = graphWidth;
+  for (const std::string& line : lines)
+    width = std::max(width, textWidth(size, line));
+  float bottom = top - lines.size() * lineHeight - padding - graphHeight;
+  drawRect(glm::vec4(left - padding, bottom - padding, left + width + padding, top + padding),
+           glm::vec4(0.0f, 0.0f, 0.0f, 0.6f));
+
+  float y = top;
+  for (const std::string& line : lines) {
+    y -= lineHeight;
+    drawText(glm::vec2(left, y), size, line, textColor);
+  }
+
+  // the scale keeps a 30 fps frame on the graph and grows with spikes
+  vector<double> history = stats.getHistory();
+  double budget = 1000.0 / GAME::FPS;
+  double scale = std::max(1000.0 / 30.0, 1.25 * stats.getPercentile(0.99));
+  float barWidth = graphWidth / FrameStats::HISTORY;
+  for (int i = 0; i < history.size(); ++i) {
+    float x = left + i * barWidth;
+    float barHeight = graphHeight * (float)std::min(1.0, history[i] / scale);
+    glm::vec4 color = history[i] <= budget ? glm::vec4(0.3f, 0.85f, 0.3f, 0.9f) : glm::vec4(0.95f, 0.3f, 0.2f, 0.9f);
+    drawRect(glm::vec4(x, bottom, x + barWidth, bottom + barHeight), color);
+  }
+  float budgetY = bottom + graphHeight * (float)std::min(1.0, budget / scale);
+  drawRect(glm::vec4(left, budgetY, left + graphWidth, budgetY + 1.0f), textColor);
 }
 
 void UIShader::render() {
+  vertices.clear();
+  buildHud();
+  if (FrameStats::theOne().isOverlayVisible())
+    buildOverlay();
+  if (vertices.empty())
+    return;
+
+  Loader::updateVBO(vboID, 0, vertices.size() * sizeof(UIVertex), &vertices.front());
+
   start();
-  glEnable(GL_CULL_FACE);
-  glEnable(GL_BLEND);
-  glDisable(GL_DEPTH_TEST);
-  loadFloat(location_health, GAME::HEALTH);
+  GLState::theOne().disable(GL_CULL_FACE);
+  GLState::theOne().enable(GL_BLEND);
+  GLState::theOne().disable(GL_DEPTH_TEST);
   loadFloat(location_width, (float)ACTUAL_WIDTH);
   loadFloat(location_height, (float)ACTUAL_HEIGHT);
-  quad->bind();
-  glDrawArrays(GL_TRIANGLES, 0, quad->getVertexCount());
-  RawModel::unbind(1);
-  stop();
-}
\ No newline at end of file
+  loadInt(location_atlas, 0);
+  FontAtlas::theOne().getTexture().bindToUint(0);
+  quads->bind();
+  glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+  FrameStats::theOne().addDraw(vertices.size() / 3);
+}
@@ -1,20 +1,49 @@
 // UIShader.h
 #pragma once
 #include "ShaderProgram.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 class RawModel;
 
+// pixel position with the origin at the bottom left, atlas uv and rgba8 color
+struct UIVertex {
+  float position[2];
+  float uv[2];
+  uint32_t color;
+};
+
+// collects the hud as quads and draws them in one call; rectangles sample
+// the solid cell of the font atlas, so text and shapes share a program
 class UIShader: public ShaderProgram {
 private:
-  RawModel* quad;
-  int location_health;
+  static const int MAX_QUADS = 2048;
+
+  RawModel* quads;
+  unsigned int vboID;
+  std::vector<UIVertex> vertices;
   int location_width;
   int location_height;
+  int location_atlas;
+
+  void addQuad(glm::vec4 rect, glm::vec4 uv, glm::vec4 color);
+  void buildHud();
+  // statistics panel and frame time graph, toggled with F3
+  void buildOverlay();
 public:
   UIShader();
   ~UIShader();
 
   void bindAttributes();
   void getAllUniformLocations();
+
+  // rect is (x0, y0, x1, y1) in pixels
+  void drawRect(glm::vec4 rect, glm::vec4 color);
+  // draws text with its bottom left corner at position, size is the glyph height
+  void drawText(glm::vec2 position, float size, const std::string& text, glm::vec4 color);
+  static float textWidth(float size, const std::string& text);
+
   void render();
-};
\ No newline at end of file
+};
@@ -0,0 +1,174 @@
+// FontAtlas.cc
+#include "FontAtlas.h"
+#include "glPrerequisites.h"
+#include <renderEngine/GLState.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <vector>
+using std::vector;
+
+const float FontAtlas::ADVANCE = 0.625f;
+
+// strokes on a 4x6 grid with the origin at the bottom left, every group of
+// four digits is one segment x0 y0 x1 y1, a segment of length 0 is a dot
+static const char* STROKES[FontAtlas::CHAR_COUNT] = {
+  "",                                             // space
+  "2226 2020",                                    // !
+  "1415 3435",                                    // "
+  "1016 3036 0242 0444",                          // #
+  "4606 0603 0343 4340 4000 2127",                // $
+  "0046 0505 4141",                               // %
+  "4006 0626 2603 0320 2044",                     // &
+  "2425",                                         // '
+  "3626 2622 2220 2030",                          // (
+  "1626 2622 2220 2010",                          // )
+  "1135 1531 0343",                               // *
+  "2024 0242",                                    // +
+  "2110",                                         // ,
+  "1333",                                         // -
+  "2020",                                         // .
+  "0046",                                         // /
+  "0040 4046 4606 0600 0046",                     // 0
+  "2026 1526 1030",                               // 1
+  "0646 4643 4303 0300 0040",                     // 2
+  "0646 4640 4000 1343",                          // 3
+  "0603 0343 3630",                               // 4
+  "4606 0603 0343 4340 4000",                     // 5
+  "4606 0600 0040 4043 4303",                     // 6
+  "0646 4620",                                    // 7
+  "0040 4046 4606 0600 0343",                     // 8
+  "4303 0306 0646 4640 4000",                     // 9
+  "2121 2424",                                    // :
+  "2424 2110",                                    // ;
+  "4103 0345",                                    // <
+  "0242 0444",                                    // =
+  "0143 4305",                                    // >
+  "0646 4643 4323 2322 2020",                     // ?
+  "3212 1214 1434 3431 3141 4146 4606 0600 0040", // @
+  "0004 0426 2644 4440 0343",                     // A
+  "0006 0636 3645 4544 4433 0333 3342 4241 4130 3000", // B
+  "4606 0600 0040",                               // C
+  "0006 0626 2644 4442 4220 2000",                // D
+  "4606 0600 0040 0333",                          // E
+  "4606 0600 0333",                               // F
+  "4606 0600 0040 4043 4323",                     // G
+  "0006 4046 0343",                               // H
+  "0646 0040 2026",                               // I
+  "0646 3631 3120 2010 1001",                     // J
+  "0006 0346 0340",                               // K
+  "0600 0040",                                    // L
+  "0006 0623 2346 4640",                          // M
+  "0006 0640 4046",                               // N
+  "0040 4046 4606 0600",                          // O
+  "0006 0646 4643 4303",                          // P
+  "0040 4046 4606 0600 2240",                     // Q
+  "0006 0646 4643 4303 1340",                     // R
+  "4606 0603 0343 4340 4000",                     // S
+  "0646 2620",                                    // T
+  "0600 0040 4046",                               // U
+  "0620 2046",                                    // V
+  "0610 1023 2330 3046",                          // W
+  "0046 0640",                                    // X
+  "0623 2346 2320",                               // Y
+  "0646 4600 0040",                               // Z
+  "3616 1610 1030",                               // [
+  "0640",                                         // backslash
+  "1636 3630 3010",                               // ]
+  "0426 2644",                                    // ^
+  "0040",                                         // _
+};
+
+// grid units are 4 pixels, the 4x6 glyph sits centered in its cell
+static const float UNIT = 4.0f;
+static const float HALF_WIDTH = 0.45f * UNIT;
+// distance in pixels over which the field goes from 0 to 1
+static const float SPREAD = 4.0f;
+
+static float segmentDistance(glm::vec2 p, glm::vec2 a, glm::vec2 b) {
+  glm::vec2 ab = b - a;
+  float lengthSquared = glm::dot(ab, ab);
+  float t = lengthSquared > 0.0f ? glm::clamp(glm::dot(p - a, ab) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+  return glm::length(p - (a + t * ab));
+}
+
+static void rasterizeGlyph(const char* strokes, uint8_t* cell, int pitch) {
+  vector<glm::vec2> points;
+  for (const char* s = strokes; s[0] && s[1] && s[2] && s[3]; s += 4) {
+    for (int i = 0; i < 4; i += 2)
+      points.push_back(glm::vec2(s[i] - '0', s[i + 1] - '0') * UNIT);
+    while (s[4] == ' ')
+      ++s;
+  }
+
+  glm::vec2 origin(0.5f * (FontAtlas::CELL_SIZE - 4.0f * UNIT), 0.5f * (FontAtlas::CELL_SIZE - 6.0f * UNIT));
+  for (int y = 0; y < FontAtlas::CELL_SIZE; ++y) {
+    for (int x = 0; x < FontAtlas::CELL_SIZE; ++x) {
+      glm::vec2 p = glm::vec2(x + 0.5f, y + 0.5f) - origin;
+      float distance = 1e6f;
+      for (int i = 0; i + 1 < points.size(); i += 2)
+        distance = std::min(distance, segmentDistance(p, points[i], points[i + 1]));
+      float value = glm::clamp(0.5f + (HALF_WIDTH - distance) / SPREAD, 0.0f, 1.0f);
+      cell[y * pitch + x] = (uint8_t)(value * 255.0f + 0.5f);
+    }
+  }
+}
+
+FontAtlas::FontAtlas() {}
+
+FontAtlas& FontAtlas::theOne() {
+  static FontAtlas atlas;
+  return atlas;
+}
+
+void FontAtlas::init() {
+  int width = COLUMNS * CELL_SIZE, height = ROWS * CELL_SIZE;
+  vector<uint8_t> pixels(width * height, 0);
+  for (int i = 0; i < CHAR_COUNT; ++i) {
+    uint8_t* cell = &pixels[(i / COLUMNS) * CELL_SIZE * width + (i % COLUMNS) * CELL_SIZE];
+    rasterizeGlyph(STROKES[i], cell, width);
+  }
+  uint8_t* solid = &pixels[(SOLID_CELL / COLUMNS) * CELL_SIZE * width + (SOLID_CELL % COLUMNS) * CELL_SIZE];
+  for (int y = 0; y < CELL_SIZE; ++y)
+    std::fill(solid + y * width, solid + y * width + CELL_SIZE, (uint8_t)255);
+
+  storage = GpuResources::theOne().createTexture(MemoryTracker::textureBytes(GL_R8, width, height), MEMORY_TEXTURES);
+  texture = Texture(storage.getID(), width);
+  GLState::theOne().bindTexture(0, GL_TEXTURE_2D, storage.getID());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, &pixels.front());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void FontAtlas::clean() {
+  storage.reset();
+  texture.setTextureID(0);
+}
+
+Texture& FontAtlas::getTexture() {
+  return texture;
+}
+
+static glm::vec4 cellRect(int cell) {
+  // half a texel inset keeps bilinear taps inside the cell
+  float inset = 0.5f;
+  float u = (cell % FontAtlas::COLUMNS) * FontAtlas::CELL_SIZE, v = (cell / FontAtlas::COLUMNS) * FontAtlas::CELL_SIZE;
+  float width = FontAtlas::COLUMNS * FontAtlas::CELL_SIZE, height = FontAtlas::ROWS * FontAtlas::CELL_SIZE;
+  return glm::vec4((u + inset) / width, (v + inset) / height,
+                   (u + FontAtlas::CELL_SIZE - inset) / width, (v + FontAtlas::CELL_SIZE - inset) / height);
+}
+
+glm::vec4 FontAtlas::getGlyph(char c) const {
+  int code = toupper((unsigned char)c) - FIRST_CHAR;
+  if (code < 0 || code >= CHAR_COUNT)
+    code = 0;
+  return cellRect(code);
+}
+
+glm::vec4 FontAtlas::getSolid() const {
+  return cellRect(SOLID_CELL);
+}
@@ -0,0 +1,35 @@
+// FontAtlas.h
+#pragma once
+#include "Texture.h"
+#include <renderEngine/GpuResources.h>
+#include <glm/glm.hpp>
+
+// signed distance field atlas for the printable ascii range 32-95, built at
+// startup from a stroke font so no font file is needed; lowercase letters
+// are drawn with their uppercase glyphs
+class FontAtlas {
+private:
+  Texture texture;
+  GpuHandle storage;
+
+  FontAtlas();
+public:
+  static const int FIRST_CHAR = 32;
+  static const int CHAR_COUNT = 64;
+  // the cell after the glyphs is filled, quads sampling it are solid rectangles
+  static const int SOLID_CELL = CHAR_COUNT;
+  static const int COLUMNS = 16;
+  static const int ROWS = 5;
+  static const int CELL_SIZE = 32;
+  // horizontal advance per character, as a fraction of the glyph height
+  static const float ADVANCE;
+
+  static FontAtlas& theOne();
+
+  void init();
+  void clean();
+  Texture& getTexture();
+  // atlas uv rectangle (u0, v0, u1, v1) of a character, or of the solid cell
+  glm::vec4 getGlyph(char c) const;
+  glm::vec4 getSolid() const;
+};
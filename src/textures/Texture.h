@@ -8,6 +8,7 @@ class Texture {
 public:
   Texture();
   Texture(const Texture& other);
+  Texture& operator=(const Texture& other);
   Texture(unsigned int textureID, int size, int type = GL_TEXTURE_2D);
 
   void bindToUint(unsigned int unit);
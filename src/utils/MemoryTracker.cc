@@ -0,0 +1,107 @@
+// MemoryTracker.cc
+#include "MemoryTracker.h"
+#include "glPrerequisites.h"
+#include <common.h>
+#include <iomanip>
+#include <iostream>
+using std::cout;
+
+static void updatePeak(std::atomic<long long>& peak, long long value) {
+  long long current = peak.load();
+  while (value > current && !peak.compare_exchange_weak(current, value)) {}
+}
+
+MemoryTracker::MemoryTracker(): totalLive(0), totalPeak(0), overBudget(false) {
+  for (int tag = 0; tag < MEMORY_TAGS; ++tag) {
+    live[tag] = 0;
+    peak[tag] = 0;
+    allocations[tag] = 0;
+  }
+}
+
+MemoryTracker& MemoryTracker::theOne() {
+  static MemoryTracker tracker;
+  return tracker;
+}
+
+void MemoryTracker::allocate(MemoryTag tag, long long bytes) {
+  updatePeak(peak[tag], live[tag] += bytes);
+  ++allocations[tag];
+  long long total = totalLive += bytes;
+  updatePeak(totalPeak, total);
+
+  // warns once per excursion over the budget
+  long long budget = (long long)MEMORY::BUDGET << 20;
+  if (budget > 0 && total > budget && !overBudget.exchange(true)) {
+    cout << "==================================================\n";
+    cout << "WARNING::MEMORY: " << (total >> 20) << " MB in use, budget is " << MEMORY::BUDGET << " MB, "
+         << getName(tag) << " went over";
+    cout << "\n==================================================\n";
+  }
+}
+
+void MemoryTracker::release(MemoryTag tag, long long bytes) {
+  live[tag] -= bytes;
+  --allocations[tag];
+  long long budget = (long long)MEMORY::BUDGET << 20;
+  if ((totalLive -= bytes) <= budget)
+    overBudget = false;
+}
+
+long long MemoryTracker::getLive(MemoryTag tag) const {
+  return live[tag];
+}
+
+long long MemoryTracker::getPeak(MemoryTag tag) const {
+  return peak[tag];
+}
+
+long long MemoryTracker::getCount(MemoryTag tag) const {
+  return allocations[tag];
+}
+
+long long MemoryTracker::getTotalLive() const {
+  return totalLive;
+}
+
+long long MemoryTracker::getTotalPeak() const {
+  return totalPeak;
+}
+
+const char* MemoryTracker::getName(MemoryTag tag) {
+  static const char* names[MEMORY_TAGS] = {
+    "entities", "colliders", "particles", "meshes", "gpu buffers", "textures", "framebuffers",
+  };
+  return names[tag];
+}
+
+long long MemoryTracker::textureBytes(unsigned int internalFormat, int width, int height) {
+  int texelSize = 4;
+  switch (internalFormat) {
+    case GL_R8:
+      texelSize = 1;
+      break;
+    case GL_DEPTH_COMPONENT16:
+      texelSize = 2;
+      break;
+    case GL_RGBA16F:
+      texelSize = 8;
+      break;
+    case GL_RGBA32F:
+      texelSize = 16;
+      break;
+  }
+  // DEPTH_COMPONENT24 is padded to 32 bits by every driver we know of
+  return (long long)texelSize * width * height;
+}
+
+void MemoryTracker::report() const {
+  cout << "MEMORY: " << std::setw(12) << "tag" << std::setw(12) << "live KB" << std::setw(12) << "peak KB"
+       << std::setw(12) << "count" << "\n";
+  for (int tag = 0; tag < MEMORY_TAGS; ++tag) {
+    cout << "        " << std::setw(12) << getName((MemoryTag)tag) << std::setw(12) << (live[tag] >> 10)
+         << std::setw(12) << (peak[tag] >> 10) << std::setw(12) << allocations[tag] << "\n";
+  }
+  cout << "        " << std::setw(12) << "total" << std::setw(12) << (totalLive >> 10) << std::setw(12)
+       << (totalPeak >> 10) << "\n";
+}
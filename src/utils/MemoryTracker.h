@@ -0,0 +1,50 @@
+// MemoryTracker.h
+#pragma once
+#include <atomic>
+
+enum MemoryTag {
+  MEMORY_ENTITIES,
+  MEMORY_COLLIDERS,
+  MEMORY_PARTICLES,
+  // cpu copies of meshes, before upload or kept for baking
+  MEMORY_MESHES,
+  MEMORY_GPU_BUFFERS,
+  // sampled textures: shadow maps and the font atlas
+  MEMORY_TEXTURES,
+  // render targets of the frame graph and the headless display
+  MEMORY_FRAMEBUFFERS,
+  MEMORY_TAGS,
+};
+
+// live bytes and high-water marks per subsystem. Owners report their own
+// allocations, gpu sizes are computed from the formats they upload, so the
+// numbers are what we asked for, not what the driver actually reserved.
+// Counters are atomic because batch worlds allocate on several threads
+class MemoryTracker {
+private:
+  std::atomic<long long> live[MEMORY_TAGS];
+  std::atomic<long long> peak[MEMORY_TAGS];
+  std::atomic<long long> allocations[MEMORY_TAGS];
+  std::atomic<long long> totalLive, totalPeak;
+  std::atomic<bool> overBudget;
+
+  MemoryTracker();
+public:
+  static MemoryTracker& theOne();
+
+  void allocate(MemoryTag tag, long long bytes);
+  void release(MemoryTag tag, long long bytes);
+
+  long long getLive(MemoryTag tag) const;
+  long long getPeak(MemoryTag tag) const;
+  // allocations not yet released
+  long long getCount(MemoryTag tag) const;
+  long long getTotalLive() const;
+  long long getTotalPeak() const;
+  static const char* getName(MemoryTag tag);
+
+  // bytes of a width x height image in one of the internal formats we use
+  static long long textureBytes(unsigned int internalFormat, int width, int height);
+  // one line per tag, in kilobytes
+  void report() const;
+};